@@ -92,8 +92,11 @@ public:
   [[nodiscard]] char get(Range, const String&, const Choices&) const;
   [[nodiscard]] char get(Range, const String&) const;
   [[nodiscard]] char get(Range, const String&, OptChar) const; ///@}
-private:
+
+  /// read a single char from stdin without waiting for 'return' (and without
+  /// echoing it), returns 0 if nothing could be read
   [[nodiscard]] static char getOneChar();
+private:
   static void add(String& prompt, const Choices&);
   static void checkPrintableAscii(char x, const String& msg);
   static void error(const String&);
@@ -2,14 +2,30 @@
 
 #include <kt_kana/KanaEnums.h>
 
+#include <array>
 #include <cassert>
-#include <set>
+#include <iosfwd>
+#include <optional>
+#include <vector>
 
 namespace kanji_tools { /// \kana_group{Converter}
-/// Converter class for converting between Rōmaji and %Kana
+/// Converter and ConverterStream classes for converting between Rōmaji and
+/// %Kana
 
 class Kana;
 
+/// Hiragana, Katakana and Rōmaji output of Converter::convertForms()
+/// \kana{Converter}
+struct KanaForms final {
+  /// return the output String for `type`
+  [[nodiscard]] String& operator[](CharType type);
+
+  /// clear all forms (keeping their capacity)
+  void clear();
+
+  String hiragana, katakana, romaji;
+};
+
 /// convert between Rōmaji, Hiragana and Katakana \kana{Converter}
 ///
 /// When the output target is Rōmaji, Revised Hepburn System (ヘボン式) is used,
@@ -33,6 +49,10 @@ class Kana;
 /// narrow to wide and vice versa (see Tokens::populateDelimLists()). Also, when
 /// converting from Rōmaji, case is ignored so both 'Dare' and 'dARe' convert to
 /// 'だれ' and lower case is used when converting from Kana to Rōmaji.
+///
+/// \note const member functions don't modify any shared state so a Converter
+///     can be used by multiple threads as long as none of them change target or
+///     flags (see convertKana() for converting without a shared Converter)
 class Converter final {
 public:
   /// set conversion `target` to Hiragana and `flags` to None by default (means
@@ -46,7 +66,10 @@ public:
   [[nodiscard]] CharType target() const { return _target; }
 
   /// set conversion target
-  void target(CharType target) { _target = target; }
+  void target(CharType target) {
+    _target = target;
+    updateOutput();
+  }
 
   /// return current conversion flags
   [[nodiscard]] auto flags() const { return _flags; }
@@ -55,10 +78,15 @@ public:
   [[nodiscard]] String flagString() const;
 
   /// set conversion flags, can set multiple at once using bitwise | operator
-  void flags(ConvertFlags flags) { _flags = flags; }
+  void flags(ConvertFlags flags) {
+    _flags = flags;
+    updateOutput();
+  }
 
   /// convert `input` using current target and flags
-  /// \details the following returns "あかちゃん" if the target is Hiragana
+  /// \details all non-target types are converted in a single pass over `input`
+  /// (see convert(CharType, const String&) to only convert one type). The
+  /// following returns "あかちゃん" if the target is Hiragana
   /// \code
   ///   convert("akaチャン");
   /// \endcode
@@ -71,6 +99,21 @@ public:
   /// \endcode
   [[nodiscard]] String convert(CharType source, const String& input) const;
 
+  /// same as the above functions, but output is appended to `out` instead of
+  /// being returned which avoids allocations when `out` is reused @{
+  void convert(StringView input, String& out) const;
+  void convert(CharType source, StringView input, String& out) const; ///@}
+
+  /// convert only `source` type chars in `input` to all three types at once
+  /// using current flags (target is ignored) appending output to `out`
+  /// \details the same `source` type is appended unchanged and converting to
+  ///     the other Kana type is a byte level shift so `input` is only processed
+  ///     by one state machine: KanaState for Rōmaji output or RomajiState for
+  ///     Kana output (which feeds each UTF-8 character to a state for both
+  ///     Hiragana and Katakana). The output is the same as separate calls to
+  ///     convert(CharType, StringView, String&) for each target.
+  void convertForms(CharType source, StringView input, KanaForms& out) const;
+
   /// update current target and flags, then convert `input`
   [[nodiscard]] String convert(
       const String& input, CharType target, ConvertFlags = ConvertFlags::None);
@@ -80,9 +123,8 @@ public:
       CharType target, ConvertFlags = ConvertFlags::None);
 
 private:
-  using Set = std::set<String>;
-  using NarrowDelims = std::map<char, String>;
-  using WideDelims = std::map<String, char>;
+  friend class ConverterStream;
+  friend class RomajiInput;
 
   /// For input, either #Apostrophe or #Dash can be used to separate 'n' in the
   /// the middle of Rōmaji words like gin'iro, kan'atsu, kan-i, etc.. For Rōmaji
@@ -92,110 +134,337 @@ private:
   static constexpr auto Apostrophe{'\''}, Dash{'-'};
   ///@}
 
+  /// trie over lower case Ascii letters built from the Rōmaji Kana map (used
+  /// by RomajiState to look up letters without allocating) \kana{Converter}
+  class RomajiTrie final {
+  public:
+    /// number of nodes (including the root) and letters supported by the trie
+    static constexpr uint16_t MaxNodes{512}, Letters{26};
+
+    RomajiTrie();
+
+    /// return Kana for Rōmaji `s` or nullptr if not found (case is ignored so
+    /// "ka", "Ka" and "KA" all find the same Kana)
+    [[nodiscard]] const Kana* find(StringView s) const;
+
+    /// return number of nodes (including the root)
+    [[nodiscard]] auto size() const { return _nodes.size(); }
+
+  private:
+    using Index = uint16_t;
+
+    /// a 'next' value of 0 means no child since the root is never a child
+    struct Node final {
+      std::array<Index, Letters> next{};
+      const Kana* kana{};
+    };
+
+    /// return index of lower case letter for `c` or #Letters if not a letter
+    [[nodiscard]] static size_t letterIndex(char c);
+
+    std::vector<Node> _nodes;
+  };
+
   /// class to hold the tokens used by Converter \kana{Converter}
+  /// \details delimiters are constexpr tables in Converter.cpp, but the trie is
+  /// built at runtime (once) since Kana data is only constexpr inside Kana.cpp
   class Tokens final {
   public:
     Tokens();
 
-    [[nodiscard]] auto& repeatingConsonants() const {
-      return _repeatingConsonants;
-    }
-    [[nodiscard]] auto& afterN(CharType t) const {
-      return t == CharType::Hiragana ? _afterNHiragana : _afterNKatakana;
-    }
-    [[nodiscard]] auto& smallKana(CharType t) const {
-      return t == CharType::Hiragana ? _smallHiragana : _smallKatakana;
-    }
-    [[nodiscard]] auto& narrowDelimList() const { return _narrowDelimList; }
-    [[nodiscard]] auto& narrowDelims() const { return _narrowDelims; }
-    [[nodiscard]] auto& wideDelims() const { return _wideDelims; }
+    [[nodiscard]] auto& romajiTrie() const { return _romajiTrie; }
 
   private:
-    /// insert and then `assert` that the value was added (can't do on one line
-    /// like `assert(s.insert(x).second)` since the code wouldn't get executed
-    /// when compiling without asserts, i.e., a 'Release Build'
-    static void insertUnique(Set& s, const String& x) {
-      [[maybe_unused]] const auto i{s.insert(x)};
-      assert(i.second);
-    }
-
-    void populateDelimLists();
-
     /// called by ctor to performs various asserts on member data
     void verifyData() const;
 
-    /// list of letters that require a small 'tsu' for sokuon (促音) output
-    std::set<char> _repeatingConsonants;
-
-    /// '_afterN...' contain the 8 Kana (5 vowels and 3 y's) that should be
-    /// proceeded with #Apostrophe when producing Rōmaji if they follow 'n' @{
-    Set _afterNHiragana, _afterNKatakana;
-    ///@}
-
-    /// '_small...' sets contain the 9 small Kana symbols (5 vowels, 3 y's, and
-    /// 'wa') that form the second parts of digraphs @{
-    Set _smallHiragana, _smallKatakana;
-    ///@}
-
-    /// Support converting most non-alpha ascii from narrow to wide values \note
-    /// These values are also used as delimiters when converting from Rōmaji to
-    /// Kana. Use '*' for Katakana middle dot '・' to keep round-trip conversion
-    /// as non-lossy as possible and '-' (dash) and apostrophe aren't included
-    /// since these could get mixed up with prolong mark 'ー' and handling after
-    /// 'n' in Rōmaji output. '\' maps to ￥ as per usual keyboard input. @{
-    String _narrowDelimList;
-    NarrowDelims _narrowDelims;
-    WideDelims _wideDelims; ///@}
+    RomajiTrie _romajiTrie;
   };
 
   /// Tokens constructor uses static maps from Kana class so wrap in a static
   /// function to avoid order of static initialization problems
   static const Tokens& tokens();
 
-  [[nodiscard]] static const Set& afterN(CharType);
-  [[nodiscard]] static const Set& smallKana(CharType);
-  [[nodiscard]] static const std::set<char>& repeatingConsonants();
-  [[nodiscard]] static const NarrowDelims& narrowDelims();
-  [[nodiscard]] static const WideDelims& wideDelims();
+  /// return true if `kana` is one of the 8 Kana (5 vowels and 3 y's) that
+  /// should be proceeded with #Apostrophe in Rōmaji output if it follows 'n'
+  [[nodiscard]] static bool isAfterN(CharType source, StringView kana);
+
+  /// return true if `kana` is one of the 9 small Kana (5 vowels, 3 y's and
+  /// 'wa') that form the second parts of digraphs
+  [[nodiscard]] static bool isSmallKana(CharType source, StringView kana);
+
+  /// return true if `c` requires a small 'tsu' for sokuon (促音) output
+  [[nodiscard]] static bool isRepeatingConsonant(char c);
+
+  /// return true if `c` separates words in Rōmaji input, i.e., #Apostrophe,
+  /// #Dash or any Ascii value that has a wide delimiter
+  [[nodiscard]] static bool isNarrowDelim(char c);
+
+  /// return wide delimiter for `c` or an empty view if there isn't one
+  [[nodiscard]] static StringView toWideDelim(char c);
+
+  /// return narrow delimiter for `wide` or '\0' if `wide` isn't a delimiter
+  [[nodiscard]] static char toNarrowDelim(StringView wide);
+
+  /// Kana output functions for a conversion `Target` and `Flags` where all
+  /// choices are made at compile time (defined in Converter.cpp)
+  template <CharType Target, ConvertFlags Flags> class BasicConverter;
+
+  /// functions of a BasicConverter instantiation \kana{Converter}
+  struct Output final {
+    StringView (*get)(const Kana&);       ///< output for a Kana
+    StringView (*getSokuon)(const Kana&); ///< sokuon Rōmaji for a Kana
+  };
+
+  /// set '_output' based on the current target and flags (called whenever they
+  /// change so output is chosen once per conversion instead of once per Kana)
+  void updateOutput();
 
   [[nodiscard]] bool romajiTarget() const;
   [[nodiscard]] bool hiraganaTarget() const;
-  [[nodiscard]] const String& get(const Kana&) const;
-  [[nodiscard]] const String& getN() const;
-  [[nodiscard]] const String& getSmallTsu() const;
-
-  [[nodiscard]] static bool isN(const String&);
+  [[nodiscard]] StringView get(const Kana&) const;
+  [[nodiscard]] StringView getN() const;
+  [[nodiscard]] StringView getSmallTsu() const;
 
-  /// takes a string of Kana (so 'source' is Hiragana or Katakana) and retuns
-  /// converted result based on '_target' and '_flags' (result can be either
-  /// Rōmaji or Kana, i.e., this function can convert Hiragana to Katakana and
-  /// vice versa).
-  [[nodiscard]] String fromKana(const String&, CharType source) const;
+  [[nodiscard]] static bool isN(StringView);
 
   enum class State { New, SmallTsu, Done };
   enum class DoneType { NewGroup, NewEmptyGroup, Prolong };
 
-  /// helper functions used by fromKana() @{
-  [[nodiscard]] String processKana(const String& kanaGroup, CharType source,
-      const Kana*& prevKana, bool prolong = false) const;
-  template <typename T>
-  [[nodiscard]] bool processOneKana(const T& done, CharType source,
-      const String& kana, const String& kanaGroup, State&) const;
-  [[nodiscard]] String processKanaMacron(bool prolong, const Kana*& prevKana,
-      const Kana* kana, bool sokuon = false) const; ///@}
+  /// state machine that takes Kana (so source is Hiragana or Katakana) one
+  /// 'character' at a time and produces output based on '_target' and '_flags'
+  /// (output can be either Rōmaji or Kana, i.e., it can convert Hiragana to
+  /// Katakana and vice versa) \kana{Converter}
+  class KanaState final {
+  public:
+    KanaState(const Converter& converter, CharType source)
+        : _converter{converter}, _source{source} {}
+
+    /// process one UTF-8 'character' appending any output to `result`
+    void add(StringView kana, String& result);
+
+    /// process remaining Kana (call after the last add())
+    void finish(String& result);
 
-  /// takes a string of Rōmaji and returns either Hiragana or Katakana based on
-  /// '_target' and '_flags'.
-  [[nodiscard]] String toKana(const String&) const;
+  private:
+    /// process Kana built up in '_kanaGroup' and by default start a new group
+    /// containing `kana` (the current symbol being processed)
+    void done(StringView kana, String& result, DoneType = DoneType::NewGroup,
+        State = State::New);
+
+    /// return false if `kana` should be added to '_kanaGroup'
+    [[nodiscard]] bool processOne(StringView kana, String& result);
+
+    const Converter& _converter;
+    const CharType _source;
+    State _state{State::New};
+    String _kanaGroup;
+    const Kana* _prevKana{};
+  };
+
+  /// state machine that takes Rōmaji one 'character' at a time and produces
+  /// either Hiragana or Katakana based on '_target' and '_flags'
+  /// \kana{Converter}
+  class RomajiState final {
+  public:
+    explicit RomajiState(const Converter& converter)
+        : _converter{converter} {}
 
-  /// helper functions used by toKana() @{
+    /// process one UTF-8 'character' appending any output to `result`, input
+    /// is broken into words separated by narrow delimiters (or control
+    /// characters like newline) which helps deal with words ending in 'n'
+    void add(StringView letter, String& result);
+
+    /// process remaining letters (called at the end of each word)
+    void finish(String& result);
+
+    /// return letters that haven't been converted yet (at most 3)
+    [[nodiscard]] auto& letters() const { return _letters; }
+
+    /// remove the last unconverted letter, returns false if there are none
+    bool backspace();
+
+  private:
+    const Converter& _converter;
+    String _letters;
+  };
+
+  /// fast path for converting Hiragana to Katakana (or vice versa) that
+  /// appends `input` to `out` and then shifts Kana Unicode values directly on
+  /// the appended UTF-8 bytes
+  /// \return false if `input` has anything that needs KanaState, i.e., invalid
+  ///     UTF-8, variation selectors, combining marks or a small Kana after a
+  ///     Kana it can't combine with (`out` is unchanged)
+  [[nodiscard]] static bool shiftKana(
+      CharType source, StringView input, String& out);
+
+  /// helper functions used by KanaState (output is appended to `result`) @{
+  void processKana(StringView kanaGroup, CharType source, const Kana*& prevKana,
+      String& result, bool prolong = false) const;
+  void processKanaMacron(bool prolong, const Kana*& prevKana, const Kana* kana,
+      String& result, bool sokuon = false) const; ///@}
+
+  /// helper functions used by RomajiState @{
   void processRomaji(String& romajiLetters, String& result) const;
   [[nodiscard]] bool processRomajiMacron(
-      const String& letter, String& letters, String& result) const; ///@}
+      StringView letter, String& letters, String& result) const; ///@}
+
+  CharType _target;      ///< current conversion target
+  ConvertFlags _flags;   ///< current conversion flags
+  const Output* _output; ///< output functions for '_target' and '_flags'
+};
 
-  CharType _target;    ///< current conversion target
-  ConvertFlags _flags; ///< current conversion flags
+/// push-style streaming version of Converter::convert() \kana{Converter}
+///
+/// Call feed() any number of times with chunks of input followed by finish().
+/// Converted output is appended to the String passed to each call and state
+/// (like pending Rōmaji letters, a trailing 'n', small 'tsu' or an unfinished
+/// UTF-8 character) is carried across chunks so the combined output is the
+/// same as calling Converter::convert() on the whole input.
+/// \note the Converter must outlive this object (its target and flags are used
+///     when converting so they shouldn't be changed until after finish())
+class ConverterStream final {
+public:
+  /// default number of bytes read at a time by convert()
+  static constexpr size_t DefaultChunkSize{64 * 1024};
+
+  /// convert all non-target types, see Converter::convert(const String&)
+  explicit ConverterStream(const Converter&);
+
+  /// only convert `source` type, see
+  /// Converter::convert(CharType, const String&)
+  ConverterStream(const Converter&, CharType source);
+
+  ConverterStream(const ConverterStream&) = delete; ///< deleted copy ctor
+
+  /// convert `chunk` appending to `out` - the end of `chunk` may be held back
+  /// until more input is provided (or finish() is called)
+  void feed(StringView chunk, String& out);
+
+  /// convert any held back input and then flush all state to `out`, this
+  /// object can be used again after calling finish()
+  void finish(String& out);
+
+  /// works like calling feed(chunk, out) followed by finish(out)
+  void finish(StringView chunk, String& out);
+
+  /// convert all of `in` to `os` reading `chunkSize` bytes at a time
+  void convert(std::istream& in, std::ostream& os,
+      size_t chunkSize = DefaultChunkSize);
+
+  /// return positions where `input` can be split so that converting each part
+  /// with a new ConverterStream gives the same output as converting all of it
+  /// \param input the text to split
+  /// \param partSize minimum size of each part (except for the last one)
+  /// \param complete false means more input follows so a position is only
+  ///     returned once there's enough of `input` to be sure it's safe
+  /// \details positions are after a newline (or other control character) or
+  ///     one of the narrow delimiters and before an Ascii character. This ends
+  ///     any Rōmaji word or Kana group, but a position is also rejected if an
+  ///     iteration mark (like ゝ) follows before any Kana of the same type
+  ///     since it repeats the previous Kana (which would be in another part).
+  [[nodiscard]] static std::vector<size_t> splitPoints(
+      StringView input, size_t partSize, bool complete = true);
+
+private:
+  /// return position in `s` where processing should stop, i.e., the start of
+  /// the last character since it can be changed by following variation
+  /// selectors, combining marks or the rest of a split UTF-8 sequence
+  [[nodiscard]] static size_t splitPoint(StringView s);
+
+  /// pass each UTF-8 character in `input` through the states appending to `out`
+  void process(StringView input, String& out);
+
+  /// the states are chained in the following order (at most two are used):
+  /// '_first' -> '_second' -> '_romaji' (Kana source is always first) @{
+  std::optional<Converter::KanaState> _first, _second;
+  std::optional<Converter::RomajiState> _romaji; ///@}
+
+  /// '_pending' holds input that's been held back by feed() and '_buffer' holds
+  /// output of the first state before it's passed to the next one @{
+  String _pending, _buffer; ///@}
 };
 
+/// incremental (IME style) conversion of typed Rōmaji \kana{Converter}
+///
+/// Call push() for each key typed and backspace() to delete. text() holds the
+/// converted Kana followed by any pending Rōmaji letters (like 'ky' before
+/// getting a vowel) and each call returns a Change describing how text() was
+/// updated so a display only needs to redraw the end. The work done per key is
+/// constant since at most a few pending letters are ever reprocessed. After
+/// flush(), text() is the same as Converter::convert() on the typed input
+/// (when backspace() wasn't used).
+class RomajiInput final {
+public:
+  /// describes how text() changed after a call (the views are only valid until
+  /// the next non-const call)
+  struct Change final {
+    StringView erased;   ///< removed from the end of the previous text()
+    StringView inserted; ///< added to the end after removing 'erased'
+  };
+
+  /// \throw DomainError if `target` is Rōmaji
+  explicit RomajiInput(CharType target = CharType::Hiragana,
+      ConvertFlags flags = ConvertFlags::None);
+
+  RomajiInput(const RomajiInput&) = delete; ///< deleted copy ctor
+
+  /// process one typed char (bytes of a multi-byte UTF-8 value, like 'ō', are
+  /// held until the value is complete and invalid UTF-8 is dropped)
+  Change push(char);
+
+  /// delete the last pending letter or the last converted character
+  Change backspace();
+
+  /// convert any pending letters (like a final 'n') as if input had ended
+  Change flush();
+
+  /// clear all text and pending letters
+  void clear();
+
+  /// return converted text followed by any pending letters
+  [[nodiscard]] StringView text() const { return _text; }
+
+  /// return the converted part of text()
+  [[nodiscard]] StringView committed() const;
+
+  /// return pending (not yet converted) letters, i.e., the end of text()
+  [[nodiscard]] StringView pending() const { return _state.letters(); }
+
+  /// return the conversion target
+  [[nodiscard]] CharType target() const { return _converter.target(); }
+
+private:
+  /// move pending letters from '_text' to '_erased' (before calling '_state')
+  /// and return the size of committed text
+  size_t removePending();
+
+  /// add pending letters back to '_text' and return the Change (skipping any
+  /// unchanged letters) since removePending() returned `start`
+  Change appendPending(size_t start);
+
+  const Converter _converter;
+  Converter::RomajiState _state;
+
+  /// '_partial' holds bytes of an incomplete multi-byte value and '_erased'
+  /// holds the text removed by the last call (referred to by Change) @{
+  String _text, _partial, _erased; ///@}
+};
+
+/// convert `source` type chars in `input` to `target` appending to `out`
+/// \details this function is reentrant (it only uses local state and constant
+///     tables) so it can be called concurrently from multiple threads. The
+///     following appends "あかチャン" to `out`:
+/// \code
+///   convertKana("akaチャン", CharType::Romaji, CharType::Hiragana,
+///       ConvertFlags::None, out);
+/// \endcode
+void convertKana(StringView input, CharType source, CharType target,
+    ConvertFlags flags, String& out);
+
+/// same as above, but converts all non-`target` types (in a single pass)
+void convertKana(
+    StringView input, CharType target, ConvertFlags flags, String& out);
+
 /// \end_group
 } // namespace kanji_tools
@@ -2,6 +2,8 @@
 
 #include <kt_utils/UnicodeBlock.h>
 
+#include <algorithm>
+
 namespace kanji_tools { /// \kana_group{DisplaySize}
 /// functions for determining if a character is narrow or wide display
 
@@ -65,6 +67,95 @@ inline constexpr std::array WideBlocks{makeBlock<0x1100, 0x115F>(),
     makeBlock<0x20000, 0x2FFFD>(), makeBlock<0x30000, 0x3FFFD>()};
 // --- end generated code from 'parseEastAsiaWidth.sh' ---
 
+/// number of bits of a Code used to index into a 'page' of #WideCodes
+inline constexpr Code WidePageBits{8};
+
+/// number of Code values in a page of #WideCodes
+inline constexpr Code WidePageSize{1U << WidePageBits};
+
+/// number of pages covered by #WideCodes (values past the end aren't wide)
+inline constexpr Code WidePages{WideBlocks.back().end() / WidePageSize + 1};
+
+/// return an array with 'true' for pages that are only partly covered by blocks
+/// in #WideBlocks (these pages need a bitmap in #WideCodes)
+[[nodiscard]] consteval auto findMixedWidePages() {
+  std::array<bool, WidePages> result{};
+  for (auto& i : WideBlocks) {
+    if (i.start() % WidePageSize) result[i.start() / WidePageSize] = true;
+    if ((i.end() + 1) % WidePageSize) result[i.end() / WidePageSize] = true;
+  }
+  return result;
+}
+
+/// return number of distinct pages required for #WideCodes, i.e., one per page
+/// returned by findMixedWidePages() plus one 'all narrow' and one 'all wide'
+[[nodiscard]] consteval size_t countWidePages() {
+  size_t result{2};
+  for (const auto i : findMixedWidePages()) result += i;
+  return result;
+}
+
+/// two-stage lookup table (built from #WideBlocks at compile time) for finding
+/// out if a Code has wide display \details The first stage maps the 'page' of a
+/// Code (its upper bits) to one of `N` bitmaps in the second stage. Pages that
+/// are all wide or all narrow share the first two bitmaps so the whole table is
+/// only a few K (compared to searching over 100 blocks per lookup).
+/// \tparam N number of distinct pages (see countWidePages())
+template <size_t N> class WideCodeTable final {
+public:
+  /// build the table from #WideBlocks
+  consteval WideCodeTable() {
+    static_assert(N <= 1U << 8 * sizeof(uint8_t));
+    constexpr uint8_t Narrow{0}, Wide{1};
+    _pages[Wide].fill(~uint64_t{});
+    const auto mixed{findMixedWidePages()};
+    uint8_t pages{Wide + 1};
+    for (size_t i{}; i < WidePages; ++i)
+      if (mixed[i]) _index[i] = pages++;
+    for (auto& i : WideBlocks)
+      for (auto j{i.start() / WidePageSize}; j <= i.end() / WidePageSize; ++j)
+        if (!mixed[j])
+          _index[j] = Wide; // pages default to 'Narrow'
+        else
+          for (auto k{std::max<Code>(i.start(), j * WidePageSize)};
+               k <= std::min<Code>(i.end(), (j + 1) * WidePageSize - 1); ++k)
+            set(_pages[_index[j]], k % WidePageSize);
+    static_assert(Narrow == uint8_t{});
+  }
+
+  /// return true if `c` has wide display
+  [[nodiscard]] constexpr bool operator()(Code c) const noexcept {
+    const auto page{c >> WidePageBits};
+    if (page >= WidePages) return false;
+    const auto bit{c & (WidePageSize - 1)};
+    return _pages[_index[page]][bit / WordBits] >> bit % WordBits & 1U;
+  }
+
+private:
+  static constexpr Code WordBits{64};
+  using Page = std::array<uint64_t, WidePageSize / WordBits>;
+
+  static constexpr void set(Page& p, Code bit) noexcept {
+    p[bit / WordBits] |= uint64_t{1} << bit % WordBits;
+  }
+
+  std::array<uint8_t, WidePages> _index{};
+  std::array<Page, N> _pages{};
+};
+
+/// table used by isWideDisplay() (built at compile time)
+inline constexpr WideCodeTable<countWidePages()> WideCodes;
+
+/// return true if `c` has wide display, i.e., uses two columns on a terminal
+[[nodiscard]] constexpr auto isWideDisplay(Code c) noexcept {
+  return WideCodes(c);
+}
+
+/// return number of columns needed to display `c` (0 for null and non-spacing)
+[[nodiscard]] constexpr size_t displaySize(Code c) noexcept {
+  return !c || isNonSpacing(c) ? 0 : isWideDisplay(c) ? 2 : 1;
+}
+
 /// return size in terms of how many columns would be required for display on a
 /// terminal (assuming 1 for a normal char and 2 for a wide char)
 [[nodiscard]] size_t displaySize(const CodeString&);
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <kt_kana/KanaEnums.h>
+#include <kt_utils/Utf8.h>
 
+#include <array>
 #include <optional>
-#include <vector>
+#include <span>
 
 namespace kanji_tools { /// \kana_group{Kana}
 /// Kana class hierarchy
@@ -14,9 +16,12 @@ namespace kanji_tools { /// \kana_group{Kana}
 /// a valid (at least typeable with standard IMEs) two Kana combo. Diagraphs are
 /// always a full sized Kana followed by a small Kana (5 vowels, 3 y's or 'wa').
 /// See #_romaji, #_hepburn and #_kunrei members for more details.
+///
+/// All Kana objects (and the maps used to look them up) are `constexpr` so
+/// they are built at compile time and there's no start-up cost for using them.
 class Kana {
 public:
-  using Map = std::map<String, const class Kana*>;
+  class Map;
   using OptString = std::optional<String>;
   template <size_t N> using CharArray = const char (&)[N];
 
@@ -37,7 +42,7 @@ public:
 
   /// Prolong Mark (ー) is officially in the Katakana Unicode block, but it can
   /// also occasionally appear in some (non-standard) Hiragana like らーめん.
-  inline static const String ProlongMark{"ー"};
+  static constexpr StringView ProlongMark{"ー"};
 
   /// return global Kana map for given #CharType
   [[nodiscard]] static const Map& getMap(CharType);
@@ -52,6 +57,51 @@ public:
   /// \return 'han-dakuten' version of `s` or `std::nullopt` if not found
   [[nodiscard]] static OptString findHanDakuten(const String& s);
 
+  /// first and last Unicode values covered by composeDakuten() and
+  /// composeHanDakuten(), i.e., the Hiragana and Katakana blocks
+  static constexpr Code CompositionStart{U'\x3040'},
+      CompositionEnd{U'\x30ff'};
+
+  /// return 'dakuten' (or 'han-dakuten') version of a single Kana Unicode value
+  /// (U+304B (か) returns "が", U+30DB (ホ) returns "ポ", etc.)
+  /// \param c Unicode value, anything outside the Kana blocks returns empty
+  /// \return view of a static Kana String or an empty view if not found
+  /// \details lookup is a direct index into a table (built at compile time)
+  ///     covering #CompositionStart to #CompositionEnd so it's cheaper than
+  ///     using findDakuten() and findHanDakuten() for Combining Marks @{
+  [[nodiscard]] static StringView composeDakuten(Code c);
+  [[nodiscard]] static StringView composeHanDakuten(Code c); ///@}
+
+  /// find global Kana for a single Kana or a digraph (Kana followed by a small
+  /// Kana like き + ゃ) without any String comparisons
+  /// \param source Hiragana or Katakana (Rōmaji always returns nullptr)
+  /// \param first Unicode value of the first (or only) Kana
+  /// \param second optional Unicode value of a small Kana (from the same block
+  ///     as `first`) that forms the second part of a digraph
+  /// \return pointer to global Kana or nullptr if not found
+  /// \details lookup is a direct index into a table (one per #CharType)
+  ///     using the position of `first` in its Unicode block and the 'slot' of
+  ///     `second` (one of the 9 small Kana that can end a digraph)
+  [[nodiscard]] static const Kana* find(
+      CharType source, Code first, Code second = {});
+
+  /// find global Kana for one or two Kana (3 or 6 bytes of UTF-8) in `s`, any
+  /// other value returns nullptr (see find() above)
+  [[nodiscard]] static const Kana* find(CharType source, StringView s);
+
+  /// return Unicode value of the first 3 bytes of `s` (all Kana are 3 bytes of
+  /// UTF-8) or 0 if they aren't a well-formed 3 byte UTF-8 sequence
+  [[nodiscard]] static constexpr Code kanaCode(StringView s) {
+    constexpr auto Shift{6};
+    const auto byte{[&s](size_t i) { return static_cast<uint8_t>(s[i]); }};
+    if (s.size() < OneKanaSize || (byte(0) & FourBits) != ThreeBits ||
+        (byte(1) & TwoBits) != Bit1 || (byte(2) & TwoBits) != Bit1)
+      return {};
+    return static_cast<Code>(byte(0) & ~FourBits) << Shift * 2 |
+           static_cast<Code>(byte(1) & ~TwoBits) << Shift |
+           static_cast<Code>(byte(2) & ~TwoBits);
+  }
+
   /// holds any further variant Rōmaji values for a Kana object \kana{Kana}
   ///
   /// This includes IME key combos that map to the same value like 'kwa' for
@@ -60,42 +110,76 @@ public:
   /// should be `std::nullopt`).
   class RomajiVariants final {
   public:
-    using List = std::vector<String>;
+    using List = std::span<const StringView>;
     using RMax = CharArray<RomajiArrayMax>;
 
-    RomajiVariants() = default; ///< default ctor (for an empty list)
-    RomajiVariants(RomajiVariants&&) = default; ///< only allow moving
+    constexpr RomajiVariants() = default; ///< default ctor (for an empty list)
 
     /// ctor for one variant
     template <size_t R>
-    explicit RomajiVariants(CharArray<R> r, bool kunrei = false);
+    constexpr explicit RomajiVariants(CharArray<R> r, bool kunrei = false);
 
     /// ctor for two variants, variants are same size like 'fa' (ファ) which has
     /// variants of 'fwa' and 'hwa'
     template <size_t R>
-    RomajiVariants(CharArray<R> r1, CharArray<R> r2, bool kunrei = false);
+    constexpr RomajiVariants(
+        CharArray<R> r1, CharArray<R> r2, bool kunrei = false);
 
     /// ctor for three variants, these instances never have `kunrei` true, but
     /// one has differing sizes so need two template params, i.e, small 'ぇ'
     /// with Rōmaji of 'le' has a variant list of 'xe', 'lye' and 'xye'
-    template <size_t R> RomajiVariants(CharArray<R> r1, RMax r2, RMax r3);
+    template <size_t R>
+    constexpr RomajiVariants(CharArray<R> r1, RMax r2, RMax r3);
 
     /// return list of variants
-    [[nodiscard]] auto& list() const { return _list; }
+    [[nodiscard]] constexpr List list() const { return {_list.data(), _size}; }
 
     /// return true if the first variant is a 'kunrei' variant
-    [[nodiscard]] auto kunrei() const { return _kunrei; }
+    [[nodiscard]] constexpr auto kunrei() const { return _kunrei; }
 
   private:
+    static constexpr size_t MaxVariants{3};
+
     /// all Rōmaji variants are either 2 or 3 characters long
     template <size_t R> static consteval void check() {
       static_assert(R > RomajiArrayMin && R <= RomajiArrayMax);
     }
 
-    List _list;
+    std::array<StringView, MaxVariants> _list{};
+    size_t _size{};
     bool _kunrei{false};
   };
 
+  /// list of Kana sorted by Rōmaji, Hiragana or Katakana keys \kana{Kana}
+  ///
+  /// Each map is an array that's built and sorted at compile time (so it can be
+  /// placed in read-only data) and find() uses a binary search.
+  class Map final {
+  public:
+    using Entry = std::pair<StringView, const Kana*>;
+    using List = std::span<const Entry>;
+
+    /// create a Map from a sorted list of unique keys
+    explicit constexpr Map(List list) noexcept : _list{list} {}
+
+    Map(const Map&) = delete; ///< deleted copy ctor
+
+    /// return Kana for `key` or nullptr if not found
+    [[nodiscard]] const Kana* find(StringView key) const;
+
+    /// return true if `key` is in the map
+    [[nodiscard]] bool contains(StringView key) const { return find(key); }
+
+    [[nodiscard]] constexpr auto begin() const noexcept {
+      return _list.begin();
+    }
+    [[nodiscard]] constexpr auto end() const noexcept { return _list.end(); }
+    [[nodiscard]] constexpr auto size() const noexcept { return _list.size(); }
+
+  private:
+    const List _list;
+  };
+
   /// holds Kana iteration marks (一の字点) \kana{Kana}
   class IterationMark final {
   public:
@@ -106,36 +190,35 @@ public:
     /// \li `matches(CharType::Katakana, "ゞ")` returns false
     /// \li `matches(CharType::Katakana, "か")` returns false
     /// CharType::Romaji will always return false
-    [[nodiscard]] bool matches(CharType t, const String& s) const;
+    [[nodiscard]] bool matches(CharType t, StringView s) const;
 
     /// return the iteration mark for `target`, if `target` is Hiragana or
     /// Katakana then the corresponding data member is returned, otherwise a
     /// Rōmaji String is returned based on `flags` and `prevKana` \details
     /// \code
     ///   using enum CharType;
-    ///   auto* prev{Kana::getMap(Romaji).find("tsu")->second};
+    ///   auto* prev{Kana::getMap(Romaji).find("tsu")};
     ///   auto flags{ConvertFlags::None};
     ///   Kana::RepeatPlain.get(Hiragana, flags, prev);  // returns "ゝ"
     ///   Kana::RepeatPlain.get(Romaji, flags, prev);    // returns "tsu"
     ///   Kana::RepeatAccented.get(Romaji, flags, prev); // returns "du"
     /// \endcode
-    [[nodiscard]] const String& get(
+    [[nodiscard]] StringView get(
         CharType target, ConvertFlags flags, const Kana* prevKana) const;
 
     /// return Hiragana iteration mark
-    [[nodiscard]] auto& hiragana() const { return _hiragana; }
+    [[nodiscard]] constexpr auto& hiragana() const { return _hiragana; }
 
     /// return Katakana iteration mark
-    [[nodiscard]] auto& katakana() const { return _katakana; }
+    [[nodiscard]] constexpr auto& katakana() const { return _katakana; }
 
   private:
     friend Kana; // only Kana class can construct
-    IterationMark(CharArray<OneKanaArraySize> hiragana,
-        CharArray<OneKanaArraySize> katakana, bool dakuten);
+    constexpr IterationMark(CharArray<OneKanaArraySize> hiragana,
+        CharArray<OneKanaArraySize> katakana, bool dakuten)
+        : _hiragana{hiragana}, _katakana{katakana}, _dakuten{dakuten} {}
 
-    void validate() const;
-
-    const String _hiragana, _katakana;
+    const StringView _hiragana, _katakana;
     const bool _dakuten; ///< true if this instance is 'dakuten' (濁点) version
   };
 
@@ -144,16 +227,20 @@ public:
 
   /// return iteration mark or nullptr if `kana` isn't an iteration mark
   [[nodiscard]] static const IterationMark* findIterationMark(
-      CharType, const String& kana);
+      CharType, StringView kana);
 
-  virtual ~Kana() = default;  ///< default dtor
-  Kana(const Kana&) = delete; ///< deleted copy ctor
+  constexpr virtual ~Kana() = default; ///< default dtor
+  Kana(const Kana&) = delete;          ///< deleted copy ctor
 
   /// DakutenKana return accented Kana, base class returns `nullptr`
-  [[nodiscard]] virtual const Kana* dakuten() const;
+  [[nodiscard]] constexpr virtual const Kana* dakuten() const {
+    return nullptr;
+  }
 
   /// HanDakutenKana return accented Kana, base class returns `nullptr`
-  [[nodiscard]] virtual const Kana* hanDakuten() const;
+  [[nodiscard]] constexpr virtual const Kana* hanDakuten() const {
+    return nullptr;
+  }
 
   /// return the unaccented version of this Kana or `nullptr` if this Kana is
   /// unaccented or is a combination that doesn't have an equivalent unaccented
@@ -161,7 +248,7 @@ public:
   ///
   /// \note ウォ can be typed with 'u' then 'lo', but is treated as two separate
   /// Kana instances ('u' and 'lo') instead of a plain version of 'vo'.
-  [[nodiscard]] virtual const Kana* plain() const;
+  [[nodiscard]] constexpr virtual const Kana* plain() const { return nullptr; }
 
   /// return 'dakuten' string for the given #CharType or `std::nullopt` if this
   /// instance doesn't have a 'dakuten' version (like 'ma')
@@ -188,28 +275,49 @@ public:
   /// type is AccentedKana (and is contained in a HanDakutenKana object)
   [[nodiscard]] bool isHanDakuten() const;
 
-  /// return Rōmaji value based on `flags`
-  [[nodiscard]] const String& getRomaji(ConvertFlags flags) const;
+  /// number of Rōmaji forms, i.e., all combinations of Hepburn and Kunrei
+  static constexpr size_t RomajiForms{4};
+
+  /// return index of the Rōmaji form for `flags` (only Hepburn and Kunrei
+  /// flags affect Rōmaji output)
+  [[nodiscard]] static constexpr size_t romajiForm(ConvertFlags flags) {
+    return static_cast<size_t>(flags & (ConvertFlags::Hepburn |
+                                           ConvertFlags::Kunrei));
+  }
+
+  /// return Rōmaji value based on `flags` (values for all forms are resolved
+  /// at compile time so this is just an array lookup)
+  [[nodiscard]] constexpr StringView getRomaji(ConvertFlags flags) const {
+    return _romajiForms[romajiForm(flags)];
+  }
 
-  /// repeat the first letter of #_romaji for sokuon (促音) output (special
-  /// handling for 't' as described in comments above).
-  [[nodiscard]] String getSokuonRomaji(ConvertFlags) const;
+  /// return Rōmaji value based on `flags` with the first letter repeated for
+  /// sokuon (促音) output (special handling for 't' as described in comments
+  /// above) - these are also built at compile time
+  [[nodiscard]] constexpr StringView getSokuonRomaji(ConvertFlags flags) const {
+    const auto form{romajiForm(flags)};
+    return {_sokuon[form].data(), _romajiForms[form].size() + 1};
+  }
 
-  [[nodiscard]] const String& get(CharType, ConvertFlags) const;
+  [[nodiscard]] StringView get(CharType, ConvertFlags) const;
 
   /// return true if `s` is equal to #_hiragana or #_katakana
-  [[nodiscard]] bool containsKana(const String& s) const;
+  [[nodiscard]] bool containsKana(StringView s) const;
 
   [[nodiscard]] bool operator==(const Kana&) const; ///< equal operator
 
-  [[nodiscard]] auto& romaji() const { return _romaji; }
-  [[nodiscard]] auto& hiragana() const { return _hiragana; }
-  [[nodiscard]] auto& katakana() const { return _katakana; }
-  [[nodiscard]] auto& romajiVariants() const { return _variants.list(); }
-  [[nodiscard]] auto kunreiVariant() const { return _variants.kunrei(); }
+  [[nodiscard]] constexpr auto& romaji() const { return _romaji; }
+  [[nodiscard]] constexpr auto& hiragana() const { return _hiragana; }
+  [[nodiscard]] constexpr auto& katakana() const { return _katakana; }
+  [[nodiscard]] constexpr auto romajiVariants() const {
+    return _variants.list();
+  }
+  [[nodiscard]] constexpr auto kunreiVariant() const {
+    return _variants.kunrei();
+  }
 
   /// instances of Kana classes are created in Kana.cpp - this ctor shouldn't be
-  /// used anywhere else
+  /// used anywhere else (constexpr ctors are also defined in Kana.cpp)
   ///
   /// \tparam R size of `romaji` char array
   /// \tparam A size of `hiragana` and `katakana` char arrays
@@ -217,7 +325,8 @@ public:
   /// \param hiragana UTF-8 Hiragana value
   /// \param katakana UTF-8 Katakana value
   template <size_t R, size_t A>
-  Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana);
+  constexpr Kana(
+      CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana);
 
   /// \doc Kana(CharArray<R>, CharArray<A>, CharArray<A>)
   /// \tparam H size of `hepburn` char array
@@ -225,52 +334,53 @@ public:
   /// \param hepburn Hepburn reading
   /// \param kunrei Kunrei reading
   template <size_t R, size_t A, size_t H, size_t K>
-  Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana,
-      CharArray<H> hepburn, CharArray<K> kunrei);
+  constexpr Kana(CharArray<R> romaji, CharArray<A> hiragana,
+      CharArray<A> katakana, CharArray<H> hepburn, CharArray<K> kunrei);
 
   /// \doc Kana(CharArray<R>, CharArray<A>, CharArray<A>)
   /// \param variants list of one or more Rōmaji variants
   template <size_t R, size_t A>
-  Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana,
-      RomajiVariants&& variants);
+  constexpr Kana(CharArray<R> romaji, CharArray<A> hiragana,
+      CharArray<A> katakana, const RomajiVariants& variants);
 
 protected:
-  /// move ctor used by AccentedKana - moves #_variants and copies other fields
-  /// since they are 'const' (copy is fine since other fields are short strings
-  /// that wouldn't benefit from move anyway because of SSO).
-  Kana(Kana&&) = default;
+  /// move ctor used by AccentedKana (all fields are views so this is a copy)
+  constexpr Kana(Kana&&) = default;
 
 private:
   template <size_t R, size_t A>
-  Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana,
-      const char* hepburn, const char* kunrei, RomajiVariants&&);
+  constexpr Kana(CharArray<R> romaji, CharArray<A> hiragana,
+      CharArray<A> katakana, StringView hepburn, StringView kunrei,
+      const RomajiVariants&);
 
-  static Map populate(CharType);
   static const Map RomajiMap, HiraganaMap, KatakanaMap;
 
-  /// called by ctors to make sure data is valid (via asserts) such as ensuring
-  /// #_hiragana is actually valid Hiragana, etc..
-  void validate() const;
-
   /// usually 'Modern Hepburn', but sometimes 'Nihon Shiki' ('di' for ぢ, 'du'
   /// for づ, etc.) to ensure uniqueness (for keys and round-trip processing)
-  const String _romaji;
+  const StringView _romaji;
 
-  const String _hiragana; ///< Hiragana value
-  const String _katakana; ///< Katakana value
+  const StringView _hiragana; ///< Hiragana value
+  const StringView _katakana; ///< Katakana value
 
   /// 'Modern Hepburn' is only populated if it's not the same as #_romaji. For
   /// example, づ can be uniquely identified by 'du', but the Hepburn value for
   /// this Kana is 'zu' which is ambiguous with ず. If #_hepburn is populated it
   /// will always be a duplicate of another Kana's #_romaji value.
-  const OptString _hepburn;
+  const StringView _hepburn;
 
   /// 'Kunrei Shiki' is only populated if it's not the same as #_romaji (like
   /// 'zya' for じゃ) and this instance doesn't have any entries in #_variants
-  const OptString _kunrei;
+  const StringView _kunrei;
+
+  /// list of Rōmaji variants
+  const RomajiVariants _variants;
+
+  /// Rōmaji values for each form (see romajiForm())
+  const std::array<StringView, RomajiForms> _romajiForms;
 
-  /// list of Rōmaji variants (non-const to allow moving)
-  RomajiVariants _variants;
+  /// sokuon Rōmaji values for each form (no null terminators are needed since
+  /// the size of each value is one more than the corresponding Rōmaji form)
+  const std::array<std::array<char, RomajiStringMax + 1>, RomajiForms> _sokuon;
 };
 
 /// class for Kana that have voiced versions \kana{Kana}
@@ -284,10 +394,15 @@ class DakutenKana : public Kana {
 public:
   /// `dakuten` should be a Kana object with accented values (like 'ga') and the
   /// base class ctor is called with the remaining parameters in `T`
-  template <typename... T> explicit DakutenKana(Kana&& dakuten, T&&...);
+  template <typename... T>
+  constexpr explicit DakutenKana(Kana&& dakuten, T&&...);
+
+  constexpr ~DakutenKana() override {} ///< constexpr dtor
 
   /// return #_dakuten Kana (which is an instance of AccentedKana)
-  [[nodiscard]] const Kana* dakuten() const final;
+  [[nodiscard]] constexpr const Kana* dakuten() const final {
+    return &_dakuten;
+  }
 
 protected:
   /// represents an accented Kana \kana{Kana}
@@ -297,10 +412,13 @@ protected:
   class AccentedKana final : public Kana {
   public:
     /// move ctor that moves `k` into base class fields and sets #_plain to `p`
-    AccentedKana(Kana&& k, const Kana& p);
+    constexpr AccentedKana(Kana&& k, const Kana& p)
+        : Kana{std::move(k)}, _plain{p} {}
+
+    constexpr ~AccentedKana() override {} ///< constexpr dtor
 
     /// return #_plain Kana
-    [[nodiscard]] const Kana* plain() const final;
+    [[nodiscard]] constexpr const Kana* plain() const final { return &_plain; }
 
   private:
     /// populated by unaccented version by DakutenKana and HanDakutenKana, for
@@ -321,10 +439,15 @@ class HanDakutenKana final : public DakutenKana {
 public:
   /// `hanDakuten` should be a Kana object with accented values (like 'pa') and
   /// the base class ctor is called with the remaining parameters in `T`
-  template <typename... T> explicit HanDakutenKana(Kana&& hanDakuten, T&&...);
+  template <typename... T>
+  constexpr explicit HanDakutenKana(Kana&& hanDakuten, T&&...);
+
+  constexpr ~HanDakutenKana() override {} ///< constexpr dtor
 
   /// return #_hanDakuten Kana (which is an instance of AccentedKana)
-  [[nodiscard]] const Kana* hanDakuten() const final;
+  [[nodiscard]] constexpr const Kana* hanDakuten() const final {
+    return &_hanDakuten;
+  }
 
 private:
   const AccentedKana _hanDakuten;
@@ -12,13 +12,15 @@ namespace kanji_tools { /// \kana_group{KanaConvert}
 /// between Hiragana, Katakana and Rōmaji \kana{KanaConvert}
 class KanaConvert final {
 public:
-  /// allow overriding in and out streams for testing
-  explicit KanaConvert(
-      const Args&, std::ostream& = std::cout, std::istream* = {});
+  /// allow overriding in, out and err streams for testing (`err` is only used
+  /// for reporting throughput in batch mode)
+  explicit KanaConvert(const Args&, std::ostream& = std::cout,
+      std::istream* = {}, std::ostream& err = std::cerr);
 
   KanaConvert(const KanaConvert&) = delete; ///< deleted copy ctor
 private:
   using List = std::vector<String>;
+  using Jobs = uint16_t;
 
   /// helper function for handling errors during processing of command-line args
   /// \throw DomainError
@@ -40,16 +42,42 @@ private:
   void start(const List& = {});
 
   void getInput();
+
+  /// live interactive mode ('-l' option), convert Rōmaji to Kana as each key
+  /// is typed using RomajiInput (only the end of the line is redrawn)
+  void liveInput();
   void printOptions() const;
   [[nodiscard]] bool processLine(const String&);
-  void convert(const String&);
+
+  /// convert `s` to '_out' using the current target (or print all forms tab
+  /// separated for '-a' option, see Converter::convertForms)
+  void convert(const String& s);
+
+  /// return value for '-j' option
+  /// \throw DomainError if `arg` isn't a number from 1 to max value of Jobs
+  [[nodiscard]] static Jobs getJobs(const String& arg);
+
+  /// return a ConverterStream for current '_converter' and '_source'
+  [[nodiscard]] ConverterStream stream() const;
+
+  /// convert `file` in chunks using ConverterStream (writes to '_out')
+  void convertFile(const std::filesystem::path& file);
+
+  /// convert `file` by splitting it into parts at safe boundaries (see
+  /// ConverterStream::splitPoints) and converting up to '_jobs' parts in
+  /// parallel. Output is written to '_out' in the original order (so it's the
+  /// same as convertFile) and throughput is reported to '_err'.
+  void convertBatch(const std::filesystem::path& file);
   void setFlag(ConvertFlags);
 
   void printKanaChart(bool markdown = false) const;
 
   std::ostream& _out;
   std::istream* _in;
-  bool _interactive{false}, _suppressNewLine{false};
+  std::ostream& _err;
+  bool _interactive{false}, _live{false}, _suppressNewLine{false},
+      _allForms{false};
+  Jobs _jobs{}; ///< number of parallel jobs for '-j' (0 means not set)
   std::optional<CharType> _source{};
   Converter _converter;
   const Choice _choice;
@@ -2,10 +2,70 @@
 
 #include <kt_utils/Utf8.h>
 
-#include <optional>
-
 namespace kanji_tools { /// \kana_group{Utf8Char}
-/// Utf8Char class for working with UTF-8 strings
+/// Utf8Char and Utf8CharView classes for working with UTF-8 strings
+
+/// non-owning version of Utf8Char that returns 'characters' as #StringView
+/// slices of the viewed data \kana{Utf8Char}
+///
+/// next() and peek() return the same values (and keep the same error, variant
+/// and combining mark counts) as the Utf8Char versions, but nothing is copied
+/// so the viewed data must outlive this object as well as any results. %Kana
+/// followed by Combining Marks are returned as views of static precomposed
+/// %Kana strings, i.e., U+306F (は) + U+3099 returns a view of "ば".
+class Utf8CharView final {
+public:
+  /// create a Utf8CharView object (doesn't copy `data`)
+  explicit Utf8CharView(StringView data) noexcept;
+
+  Utf8CharView(const Utf8CharView&) = delete; ///< deleted copy ctor
+
+  /// resets location and counters (call to allow iterating again)
+  void reset() noexcept;
+
+  /// get the next UTF-8 character (see Utf8Char::next())
+  bool next(StringView& result, bool onlyMB = true);
+
+  /// works like next(), but doesn't update internal state
+  [[nodiscard]] bool peek(StringView& result, bool onlyMB = true) const;
+
+  /// number of errors (invalid UTF-8 sequences) found in calls to next() method
+  [[nodiscard]] auto errors() const noexcept { return _errors; }
+
+  /// number of Variation Selectors found in calls to next() method
+  [[nodiscard]] auto variants() const noexcept { return _variants; }
+
+  /// number of Kana Combining Marks found in calls to next() method
+  [[nodiscard]] auto combiningMarks() const noexcept {
+    return _combiningMarks;
+  }
+
+private:
+  /// implements next() and peek() (counts are only updated if `T` is non-const)
+  /// \tparam T Utf8CharView type (either const or non-const)
+  /// \param t object to get data from (and update counts if non-const)
+  /// \param[in,out] loc location to start from, moved past the result
+  /// \param[out] result next UTF-8 character
+  /// \param onlyMB if true then skip single-byte UTF-8 characters
+  template <typename T>
+  [[nodiscard]] static bool next(
+      T& t, const char*& loc, StringView& result, bool onlyMB);
+
+  /// returns a view of a single %Kana character if `next` is a combining mark
+  /// (and moves `loc` past the mark), otherwise return `cur`
+  template <typename T>
+  [[nodiscard]] static StringView processOne(
+      T& t, const char*& loc, StringView cur, StringView next);
+
+  [[nodiscard]] const char* end() const noexcept {
+    return _data.data() + _data.size();
+  }
+
+  const StringView _data;
+  const char* _curLocation{_data.data()};
+  // counts of errors, variants and combiningMarks found
+  size_t _errors{}, _variants{}, _combiningMarks{};
+};
 
 /// provide functions for iterating, tracking variant and error counts and
 /// converting %Kana Combining Marks in UTF-8 strings \kana{Utf8Char}
@@ -23,8 +83,6 @@ namespace kanji_tools { /// \kana_group{Utf8Char}
 ///   1110 means 3, etc.
 class Utf8Char final {
 public:
-  using OptString = std::optional<String>;
-
   /// return true if the first UTF-8 value in `s` is a Variation Selector (used
   /// by size(), next() and peek() methods) @{
   [[nodiscard]] static bool isVariationSelector(const uint8_t* s);
@@ -64,7 +122,8 @@ public:
   /// 'multi-byte' UTF-8 character
   [[nodiscard]] static String getFirst(const String&);
 
-  /// create a Utf8Char object from a String
+  /// create a Utf8Char object from a String (a copy of the String is used by an
+  /// internal Utf8CharView, use Utf8CharView directly to avoid the copy)
   explicit Utf8Char(const String&);
 
   Utf8Char(const Utf8Char&) = delete; ///< deleted copy ctor
@@ -87,13 +146,13 @@ public:
   [[nodiscard]] bool peek(String& result, bool onlyMB = true) const;
 
   /// number of errors (invalid UTF-8 sequences) found in calls to next() method
-  [[nodiscard]] auto errors() const { return _errors; }
+  [[nodiscard]] auto errors() const { return _view.errors(); }
 
   /// number of Variation Selectors found in calls to next() method
-  [[nodiscard]] auto variants() const { return _variants; }
+  [[nodiscard]] auto variants() const { return _view.variants(); }
 
   /// number of Kana Combining Marks found in calls to next() method
-  [[nodiscard]] auto combiningMarks() const { return _combiningMarks; }
+  [[nodiscard]] auto combiningMarks() const { return _view.combiningMarks(); }
 
   /// return size (of string passed to ctor), see static size() function
   [[nodiscard]] size_t size(bool onlyMB = true) const;
@@ -105,47 +164,9 @@ public:
   [[nodiscard]] bool isValid(bool sizeOne = true) const;
 
 private:
-  /// return one multi-byte UTF-8 character starting at `loc`, `loc` is moved
-  /// forward by 2 to 4 bytes (depending on the size of the value returned)
-  [[nodiscard]] static String getMBUtf8(const char*& loc);
-
-  /// called from next() and peek() after determining `loc` points to a valid
-  /// multi-byte UTF-8 sequence
-  /// \param[out] result next UTF-8 character
-  /// \param loc location to pass to getMBUtf8()
-  /// \return true if `result` is not a variation selector or combining mark
-  [[nodiscard]] static bool validResult(String& result, const char*& loc);
-
-  /// called from next() and peek() methods to check if the next value (after
-  /// the one being processed) is a variation selector
-  /// \param[out] result next UTF-8 character (only set if `loc` points to a
-  ///     valid UTF-8 character)
-  /// \param loc location to validate
-  /// \return true if `loc` points to a valid multi-byte UTF-8 character and
-  ///    the character is a variation selector
-  [[nodiscard]] static bool peekVariant(String& result, const char* loc);
-
-  /// returns a String containing a single %Kana character if `next` is a
-  /// combining mark, otherwise return `cur` (calls combiningMark() functions)
-  /// \tparam T Utf8Char type (either const or non-const)
-  template <typename T>
-  [[nodiscard]] static String processOne(
-      T&, const String& cur, const String& next);
-
-  /// return `accented` if it's defined, otherwise return 'base'
-  [[nodiscard]] String combiningMark(
-      const String& base, const OptString& accented) const;
-
-  /// \doc combiningMark
-  /// also increments combining mark count if `accented` is defined, otherwise
-  /// increments error count
-  [[nodiscard]] String combiningMark(
-      const String& base, const OptString& accented);
-
   const String _data;
-  const char* _curLocation{_data.c_str()};
-  // counts of errors, variants and combiningMarks found
-  size_t _errors{}, _variants{}, _combiningMarks{};
+  // view over '_data' as a null-terminated string (so stops at the first null)
+  Utf8CharView _view{_data.c_str()};
 };
 
 /// \end_group
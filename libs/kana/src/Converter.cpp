@@ -1,73 +1,128 @@
 #include <kt_kana/Converter.h>
 #include <kt_kana/Kana.h>
 #include <kt_kana/Utf8Char.h>
+#include <kt_utils/Exception.h>
 #include <kt_utils/UnicodeBlock.h>
 
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <functional>
 #include <sstream>
+#include <stdexcept>
 
 namespace kanji_tools {
 
-Converter::Tokens::Tokens() : _narrowDelimList{Apostrophe, Dash} {
-  for (auto& i : Kana::getMap(CharType::Hiragana))
-    if (auto& r{i.second->romaji()}; !r.starts_with("n")) {
-      if (r.size() == 1 || r == "ya" || r == "yu" || r == "yo") {
-        insertUnique(_afterNHiragana, i.second->hiragana());
-        insertUnique(_afterNKatakana, i.second->katakana());
-      } else if (r.starts_with("l")) {
-        if (*i.second != Kana::SmallTsu && !r.starts_with("lk")) {
-          insertUnique(_smallHiragana, i.second->hiragana());
-          insertUnique(_smallKatakana, i.second->katakana());
-        }
-      } else
-        _repeatingConsonants.insert(r[0]);
+String& KanaForms::operator[](CharType type) {
+  switch (type) {
+  case CharType::Hiragana: return hiragana;
+  case CharType::Katakana: return katakana;
+  case CharType::Romaji: break;
+  }
+  return romaji;
+}
+
+void KanaForms::clear() {
+  hiragana.clear();
+  katakana.clear();
+  romaji.clear();
+}
+
+Converter::RomajiTrie::RomajiTrie() : _nodes(1) {
+  for (auto& i : Kana::getMap(CharType::Romaji)) {
+    Index node{};
+    for (const auto c : i.first) {
+      const auto letter{letterIndex(c)};
+      assert(letter < Letters);
+      if (auto& next{_nodes[node].next[letter]}; next)
+        node = next;
+      else {
+        assert(_nodes.size() < MaxNodes);
+        node = next = static_cast<Index>(_nodes.size());
+        _nodes.emplace_back();
+      }
     }
-  populateDelimLists();
-  verifyData();
+    _nodes[node].kana = i.second;
+  }
 }
 
-void Converter::Tokens::populateDelimLists() {
-  using Wide = Kana::CharArray<Kana::OneKanaArraySize>; // all are 3 byte UTF-8
-  struct D {
-    const char narrow;
-    Wide wide;
-  };
-  char prevChar{};
-  const auto f{[&prevChar](Wide wide, char narrow = {}) {
-    return D{narrow ? prevChar = narrow : ++prevChar, wide};
-  }}; // LCOV_EXCL_LINE
-  // add delims in Ascii order (skipping Apostrophe, Dash and Alpha)
-  for (auto& i : {f("　", ' '), f("！"), f("”"), f("＃"), f("＄"), f("％"),
-           f("＆"), /* ' */ f("（", '('), f("）"), f("＊"), f("＋"), f("、"),
-           /* - */ f("。", '.'), f("・"), f("０"), f("１"), f("２"), f("３"),
-           f("４"), f("５"), f("６"), f("７"), f("８"), f("９"), f("："),
-           f("；"), f("＜"), f("＝"), f("＞"), f("？"), f("＠"), /* A-Z */
-           f("「", '['), f("￥"), f("」"), f("＾"), f("＿"), f("｀"),
-           /* a-z */ f("『", '{'), f("｜"), f("』"), f("〜")}) {
-    _narrowDelimList += i.narrow;
-    _narrowDelims[i.narrow] = i.wide;
-    _wideDelims[i.wide] = i.narrow;
+const Kana* Converter::RomajiTrie::find(StringView s) const {
+  Index node{};
+  for (const auto c : s) {
+    const auto letter{letterIndex(c)};
+    if (letter == Letters || !_nodes[node].next[letter]) return {};
+    node = _nodes[node].next[letter];
   }
+  return _nodes[node].kana;
 }
 
+size_t Converter::RomajiTrie::letterIndex(char c) {
+  static constexpr auto CaseBit{'a' - 'A'};
+  if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + CaseBit);
+  return c >= 'a' && c <= 'z' ? static_cast<size_t>(c - 'a') : Letters;
+}
+
+namespace {
+
+/// narrow and wide delimiter pair \kana{Converter}
+struct Delim final {
+  char narrow;
+  StringView wide;
+};
+
+/// Support converting most non-alpha Ascii from narrow to wide values \note
+/// These values are also used as delimiters when converting from Rōmaji to
+/// Kana. Use '*' for Katakana middle dot '・' to keep round-trip conversion as
+/// non-lossy as possible and '-' (dash) and apostrophe aren't included since
+/// these could get mixed up with prolong mark 'ー' and handling after 'n' in
+/// Rōmaji output. '\' maps to ￥ as per usual keyboard input.
+constexpr std::array Delims{Delim{' ', "　"}, Delim{'!', "！"},
+    Delim{'"', "”"}, Delim{'#', "＃"}, Delim{'$', "＄"}, Delim{'%', "％"},
+    Delim{'&', "＆"}, Delim{'(', "（"}, Delim{')', "）"}, Delim{'*', "＊"},
+    Delim{'+', "＋"}, Delim{',', "、"}, Delim{'.', "。"}, Delim{'/', "・"},
+    Delim{'0', "０"}, Delim{'1', "１"}, Delim{'2', "２"}, Delim{'3', "３"},
+    Delim{'4', "４"}, Delim{'5', "５"}, Delim{'6', "６"}, Delim{'7', "７"},
+    Delim{'8', "８"}, Delim{'9', "９"}, Delim{':', "："}, Delim{';', "；"},
+    Delim{'<', "＜"}, Delim{'=', "＝"}, Delim{'>', "＞"}, Delim{'?', "？"},
+    Delim{'@', "＠"}, Delim{'[', "「"}, Delim{'\\', "￥"}, Delim{']', "」"},
+    Delim{'^', "＾"}, Delim{'_', "＿"}, Delim{'`', "｀"}, Delim{'{', "『"},
+    Delim{'|', "｜"}, Delim{'}', "』"}, Delim{'~', "〜"}};
+
+/// wide delimiters indexed by narrow (Ascii) value (empty if not a delimiter)
+constexpr auto WideDelims{[] {
+  std::array<StringView, MaxAscii + 1> result{};
+  for (const auto& i : Delims) result[static_cast<size_t>(i.narrow)] = i.wide;
+  return result;
+}()};
+
+/// narrow delimiters sorted by wide value (for binary search)
+constexpr auto NarrowDelims{[] {
+  auto result{Delims};
+  std::sort(result.begin(), result.end(),
+      [](auto& x, auto& y) { return x.wide < y.wide; });
+  return result;
+}()};
+
+/// return true if `Delims` doesn't have any duplicate narrow or wide values
+[[nodiscard]] consteval bool uniqueDelims() {
+  size_t narrow{};
+  for (const auto& i : WideDelims)
+    if (!i.empty()) ++narrow;
+  return narrow == Delims.size() &&
+         std::adjacent_find(NarrowDelims.begin(), NarrowDelims.end(),
+             [](auto& x, auto& y) { return x.wide == y.wide; }) ==
+             NarrowDelims.end();
+}
+
+static_assert(uniqueDelims());
+
+} // namespace
+
+Converter::Tokens::Tokens() { verifyData(); }
+
 void Converter::Tokens::verifyData() const {
   assert(Kana::N.romaji() == "n");
   assert(Kana::SmallTsu.romaji() == "ltu");
-  assert(_repeatingConsonants.size() == 18);
-  for ([[maybe_unused]] const auto i : {'a', 'i', 'u', 'e', 'o', 'l', 'n', 'x'})
-    assert(_repeatingConsonants.contains(i) == false);
-  assert(_afterNHiragana.size() == 8); // 5 vowels plus 3 y's
-  assert(_afterNHiragana.size() == _afterNKatakana.size());
-  // 5 small vowels plus 3 small y's plus small 'wa'
-  assert(_smallHiragana.size() == 9);
-  assert(_smallHiragana.size() == _smallKatakana.size());
-  for ([[maybe_unused]] auto& i : _afterNHiragana) assert(isHiragana(i));
-  for ([[maybe_unused]] auto& i : _afterNKatakana) assert(isKatakana(i));
-  for ([[maybe_unused]] auto& i : _smallHiragana) assert(isHiragana(i));
-  for ([[maybe_unused]] auto& i : _smallKatakana) assert(isKatakana(i));
-  // make sure there are no duplicate narrow or wide delims, i.e., both maps
-  // must have the same size (which is 2 less than _narrowDelimList)
-  assert(_wideDelims.size() == _narrowDelimList.size() - 2);
-  assert(_narrowDelims.size() == _wideDelims.size());
 }
 
 const Converter::Tokens& Converter::tokens() {
@@ -75,8 +130,42 @@ const Converter::Tokens& Converter::tokens() {
   return tokens;
 }
 
+template <CharType Target, ConvertFlags Flags>
+class Converter::BasicConverter final {
+public:
+  [[nodiscard]] static constexpr StringView get(const Kana& k) {
+    if constexpr (Target == CharType::Hiragana)
+      return k.hiragana();
+    else if constexpr (Target == CharType::Katakana)
+      return k.katakana();
+    else
+      return k.getRomaji(Flags);
+  }
+
+  [[nodiscard]] static constexpr StringView getSokuon(const Kana& k) {
+    return k.getSokuonRomaji(Flags);
+  }
+
+  static constexpr Output Functions{get, getSokuon};
+};
+
+void Converter::updateOutput() {
+  // instantiate BasicConverter for each target and Rōmaji form (other flags
+  // don't affect the output of a single Kana), indexed by CharType and form
+  static constexpr auto Outputs{[]<size_t... F>(std::index_sequence<F...>) {
+    using enum CharType;
+    return std::array{
+        std::array{&BasicConverter<Hiragana, ConvertFlags{F}>::Functions...},
+        std::array{&BasicConverter<Katakana, ConvertFlags{F}>::Functions...},
+        std::array{&BasicConverter<Romaji, ConvertFlags{F}>::Functions...}};
+  }(std::make_index_sequence<Kana::RomajiForms>())};
+  _output = Outputs[static_cast<size_t>(_target)][Kana::romajiForm(_flags)];
+}
+
 Converter::Converter(CharType target, ConvertFlags flags)
-    : _target{target}, _flags{flags} {}
+    : _target{target}, _flags{flags} {
+  updateOutput();
+}
 
 String Converter::flagString() const {
   if (_flags == ConvertFlags::None) return "None";
@@ -94,273 +183,485 @@ String Converter::flagString() const {
   return result;
 }
 
+namespace {
+
+/// pass each UTF-8 'character' of `input` to `state` appending to `out`
+template <typename T> void feed(T& state, StringView input, String& out) {
+  StringView c;
+  for (Utf8CharView v{input}; v.next(c, false);) state.add(c, out);
+}
+
+/// pass `input` to `first` and then pass its output (one UTF-8 'character' at
+/// a time) to `second` - this gives the same result as running `first` over
+/// all of `input` and then `second` over the result, but only needs one pass
+template <typename T, typename U>
+void feed(T& first, U& second, StringView input, String& out, String& buffer) {
+  StringView c;
+  for (Utf8CharView v{input}; v.next(c, false); buffer.clear()) {
+    first.add(c, buffer);
+    feed(second, buffer, out);
+  }
+}
+
+/// call `finish` for `first` and then `second` (passing output along)
+template <typename T, typename U>
+void finish(T& first, U& second, String& out, String& buffer) {
+  first.finish(buffer);
+  feed(second, buffer, out);
+  buffer.clear();
+  second.finish(out);
+}
+
+/// difference between Unicode values of Katakana and Hiragana
+constexpr Code KanaShift{U'ア' - U'あ'};
+
+using ShiftTable = std::array<bool,
+    Kana::CompositionEnd - Kana::CompositionStart + 1>; // Kana blocks
+
+/// return table (indexed by offset from the start of the Hiragana block) with
+/// true for each `source` value that KanaState converts by shifting, i.e., any
+/// single Kana or iteration mark
+[[nodiscard]] ShiftTable populateShiftTable(CharType source) {
+  ShiftTable result{};
+  for (auto c{Kana::CompositionStart}; c <= Kana::CompositionEnd; ++c)
+    if (Kana::find(source, c) || Kana::findIterationMark(source, toUtf8(c)))
+      result[c - Kana::CompositionStart] = true;
+  return result;
+}
+
+/// set the last two bytes of a 3 byte UTF-8 Kana starting at `s` to `c` (the
+/// first byte doesn't need to change since it's the same for all Kana)
+void setKanaBytes(char* s, Code c) {
+  static constexpr Code Continuation{0x80}, SixBits{0x3f}, Shift{6};
+  s[1] = static_cast<char>(Continuation | (c >> Shift & SixBits));
+  s[2] = static_cast<char>(Continuation | (c & SixBits));
+}
+
+/// small set of Unicode values stored as bits (indexed by offset from `Start`)
+/// so checking for a value is a bit test instead of comparing Strings
+template <Code Start> class CodeSet final {
+public:
+  consteval CodeSet(std::initializer_list<Code> codes) {
+    for (const auto c : codes) {
+      const auto i{c - Start};
+      // 'at' throws for out of range values which causes a compile error
+      auto& word{_bits.at(i / WordBits)};
+      const auto bit{uint64_t{1} << i % WordBits};
+      if (word & bit) throw std::domain_error{"duplicate value"};
+      word |= bit;
+    }
+  }
+
+  [[nodiscard]] constexpr bool contains(Code c) const {
+    const auto i{c - Start}; // values below 'Start' wrap around
+    return i < Capacity && (_bits[i / WordBits] >> i % WordBits & 1U);
+  }
+
+  [[nodiscard]] constexpr size_t size() const {
+    size_t result{};
+    for (const auto i : _bits) result += static_cast<size_t>(std::popcount(i));
+    return result;
+  }
+
+private:
+  static constexpr Code WordBits{64}, Capacity{128};
+  std::array<uint64_t, Capacity / WordBits> _bits{};
+};
+
+/// the 8 Kana (5 vowels and 3 y's) that should be proceeded with Apostrophe
+/// when producing Rōmaji if they follow 'n' (Hiragana values are stored and
+/// Katakana is shifted to Hiragana when checking)
+constexpr CodeSet<Kana::CompositionStart> AfterN{
+    U'あ', U'い', U'う', U'え', U'お', U'や', U'ゆ', U'よ'};
+
+/// the 9 small Kana (5 vowels, 3 y's and 'wa') that form the second parts of
+/// digraphs (stored as Hiragana like #AfterN)
+constexpr CodeSet<Kana::CompositionStart> SmallKana{
+    U'ぁ', U'ぃ', U'ぅ', U'ぇ', U'ぉ', U'ゃ', U'ゅ', U'ょ', U'ゎ'};
+
+/// letters that require a small 'tsu' for sokuon (促音) output
+constexpr CodeSet<Code{}> RepeatingConsonants{U'b', U'c', U'd', U'f', U'g',
+    U'h', U'j', U'k', U'm', U'p', U'q', U'r', U's', U't', U'v', U'w', U'y',
+    U'z'};
+
+static_assert(AfterN.size() == 8 && SmallKana.size() == 9);
+static_assert(!RepeatingConsonants.contains(U'a') &&
+              !RepeatingConsonants.contains(U'l') &&
+              !RepeatingConsonants.contains(U'n') &&
+              !RepeatingConsonants.contains(U'x'));
+
+/// return true if `kana` is a single Hiragana or Katakana (based on `source`)
+/// value and its Hiragana equivalent is in `set`
+[[nodiscard]] bool containsKana(
+    const CodeSet<Kana::CompositionStart>& set, CharType source,
+    StringView kana) {
+  if (kana.size() != Kana::OneKanaSize) return false;
+  const auto c{Kana::kanaCode(kana)};
+  return set.contains(source == CharType::Katakana ? c - KanaShift : c);
+}
+
+} // namespace
+
+bool Converter::shiftKana(CharType source, StringView input, String& out) {
+  static const ShiftTable Hiragana{populateShiftTable(CharType::Hiragana)},
+      Katakana{populateShiftTable(CharType::Katakana)};
+  const auto hiragana{source == CharType::Hiragana};
+  const auto& table{hiragana ? Hiragana : Katakana};
+  const auto start{out.size()};
+  out += input;
+  const auto v{StringView{out}.substr(start)};
+  // skip Ascii runs (using block scanning) and then process one MB character
+  for (size_t i{}; (i += asciiPrefixSize(v.substr(i))) < v.size();) {
+    const auto size{getMBUtf8Size(v.substr(i))};
+    // KanaState only shifts the first Kana of a group like 'ッヘャ' where a
+    // small Kana follows a Kana it can't combine with so fall back in this case
+    if (!size || Utf8Char::isVariationSelector(v.data() + i) ||
+        Utf8Char::isCombiningMark(v.data() + i) ||
+        (i >= Kana::OneKanaSize && isSmallKana(source, input.substr(i, size)) &&
+            Kana::find(source, input.substr(i - Kana::OneKanaSize,
+                                   Kana::OneKanaSize)) &&
+            !Kana::find(source, input.substr(i - Kana::OneKanaSize,
+                                    Kana::OneKanaSize + size)))) {
+      out.resize(start);
+      return false;
+    }
+    if (size == Kana::OneKanaSize)
+      if (const auto c{*Utf8View{v.substr(i, size)}.begin()};
+          c >= Kana::CompositionStart && c <= Kana::CompositionEnd &&
+          table[c - Kana::CompositionStart])
+        setKanaBytes(
+            out.data() + start + i, hiragana ? c + KanaShift : c - KanaShift);
+    i += size;
+  }
+  return true;
+}
+
 String Converter::convert(const String& input) const {
-  String result{input};
-  for (const auto i : CharTypes)
-    if (_target != i) result = convert(i, result);
+  String result;
+  convert(StringView{input}, result);
   return result;
 }
 
 String Converter::convert(
     const String& input, CharType target, ConvertFlags flags) {
   _target = target;
-  _flags = flags;
+  this->flags(flags);
   return convert(input);
 }
 
 String Converter::convert(
     CharType source, const String& input, CharType target, ConvertFlags flags) {
   _target = target;
-  _flags = flags;
+  this->flags(flags);
   return convert(source, input);
 }
 
 String Converter::convert(CharType source, const String& input) const {
-  if (source == _target) return input;
-  if (source == CharType::Hiragana) return fromKana(input, source);
-  if (source == CharType::Katakana) return fromKana(input, source);
-  // For Romaji source, break into words separated by any of _narrowDelimList
-  // and process each word. This helps deal with words ending in 'n'.
   String result;
-  size_t oldPos{};
-  for (const auto keepSpaces{!(_flags & ConvertFlags::RemoveSpaces)};;) {
-    const auto pos{input.find_first_of(tokens().narrowDelimList(), oldPos)};
-    if (pos == String::npos) {
-      result += toKana(input.substr(oldPos));
-      break;
-    }
-    result += toKana(input.substr(oldPos, pos - oldPos));
-    if (const auto delim{input[pos]};
-        delim != Apostrophe && delim != Dash && (keepSpaces || delim != ' '))
-      result += narrowDelims().at(delim);
-    oldPos = pos + 1;
-  }
+  convert(source, input, result);
   return result;
 }
 
-const Converter::Set& Converter::afterN(CharType source) {
-  return tokens().afterN(source);
+void Converter::convert(StringView input, String& out) const {
+  ConverterStream{*this}.finish(input, out);
 }
 
-const Converter::Set& Converter::smallKana(CharType source) {
-  return tokens().smallKana(source);
+void Converter::convert(CharType source, StringView input, String& out) const {
+  if (source == _target)
+    out += input;
+  else if (source == CharType::Romaji || romajiTarget() ||
+           !shiftKana(source, input, out))
+    ConverterStream{*this, source}.finish(input, out);
 }
 
-const std::set<char>& Converter::repeatingConsonants() {
-  return tokens().repeatingConsonants();
+void Converter::convertForms(
+    CharType source, StringView input, KanaForms& out) const {
+  out[source] += input;
+  if (source == CharType::Romaji) {
+    const Converter hiragana{CharType::Hiragana, _flags},
+        katakana{CharType::Katakana, _flags};
+    RomajiState h{hiragana}, k{katakana};
+    StringView c;
+    for (Utf8CharView v{input}; v.next(c, false);) {
+      h.add(c, out.hiragana);
+      k.add(c, out.katakana);
+    }
+    h.finish(out.hiragana);
+    k.finish(out.katakana);
+  } else {
+    const auto other{source == CharType::Hiragana ? CharType::Katakana
+                                                  : CharType::Hiragana};
+    Converter{other, _flags}.convert(source, input, out[other]);
+    Converter{CharType::Romaji, _flags}.convert(source, input, out.romaji);
+  }
 }
 
-const Converter::NarrowDelims& Converter::narrowDelims() {
-  return tokens().narrowDelims();
+bool Converter::isAfterN(CharType source, StringView kana) {
+  return containsKana(AfterN, source, kana);
 }
 
-const Converter::WideDelims& Converter::wideDelims() {
-  return tokens().wideDelims();
+bool Converter::isSmallKana(CharType source, StringView kana) {
+  return containsKana(SmallKana, source, kana);
 }
 
-bool Converter::romajiTarget() const { return _target == CharType::Romaji; }
-
-bool Converter::hiraganaTarget() const { return _target == CharType::Hiragana; }
+bool Converter::isRepeatingConsonant(char c) {
+  return RepeatingConsonants.contains(toUChar(c));
+}
 
-const String& Converter::get(const Kana& k) const {
-  return k.get(_target, _flags);
+bool Converter::isNarrowDelim(char c) {
+  return c == Apostrophe || c == Dash || !toWideDelim(c).empty();
 }
 
-const String& Converter::getN() const { return get(Kana::N); }
+StringView Converter::toWideDelim(char c) {
+  return toUChar(c) <= MaxAscii ? WideDelims[toUChar(c)] : StringView{};
+}
 
-const String& Converter::getSmallTsu() const { return get(Kana::SmallTsu); }
+char Converter::toNarrowDelim(StringView wide) {
+  const auto i{std::lower_bound(NarrowDelims.begin(), NarrowDelims.end(), wide,
+      [](auto& x, auto y) { return x.wide < y; })};
+  return i != NarrowDelims.end() && i->wide == wide ? i->narrow : '\0';
+}
 
-bool Converter::isN(const String& x) { return x == "n" || x == "N"; }
+bool Converter::romajiTarget() const { return _target == CharType::Romaji; }
 
-String Converter::fromKana(const String& kanaInput, CharType source) const {
-  State state{State::New};
-  String result, kanaGroup, kana;
-  const Kana* prevKana{};
+bool Converter::hiraganaTarget() const { return _target == CharType::Hiragana; }
 
-  // 'done' is called to process the Kana built up in 'kanaGroup'. By default it
-  // starts a new group containing 'kana' (the current symbol being processed).
-  const auto done{[this, source, &state, &result, &kanaGroup, &kana, &prevKana](
-                      DoneType dt = DoneType::NewGroup, State ns = State::New) {
-    // NOLINTNEXTLINE: NonNullParamChecker
-    result += processKana(kanaGroup, source, prevKana, dt == DoneType::Prolong);
-    if (romajiTarget() && Kana::N.containsKana(kanaGroup) &&
-        afterN(source).contains(kana))
-      result += Apostrophe;
-    kanaGroup = dt == DoneType::NewGroup ? kana : emptyString();
-    state = ns;
-  }};
+StringView Converter::get(const Kana& k) const {
+  return _output->get(k);
+}
 
-  for (Utf8Char s{kanaInput}; s.next(kana, false);) {
-    // check prolong and repeating marks first since they aren't in 'sourceMap'
-    if (kana == Kana::ProlongMark)
-      // prolong is 'katakana', but it can appear in (non-standard) Hiragana.
-      done(DoneType::Prolong);
-    else if (const auto repeat{Kana::findIterationMark(source, kana)}; repeat) {
-      done(DoneType::NewEmptyGroup);
-      result += repeat->get(_target, _flags, prevKana);
-    } else if (Kana::getMap(source).contains(kana)) {
-      if (!processOneKana(done, source, kana, kanaGroup, state))
-        kanaGroup += kana;
-    } else {
-      // got non-kana so flush any letters and preserve new letter unconverted
-      done(DoneType::NewEmptyGroup);
-      if (romajiTarget())
-        if (const auto i{wideDelims().find(kana)}; i != wideDelims().end()) {
-          result += i->second;
-          continue;
-        }
-      result += kana;
-    }
+StringView Converter::getN() const { return get(Kana::N); }
+
+StringView Converter::getSmallTsu() const { return get(Kana::SmallTsu); }
+
+bool Converter::isN(StringView x) { return x == "n" || x == "N"; }
+
+void Converter::KanaState::add(StringView kana, String& result) {
+  // check prolong and repeating marks first since they aren't found by 'find'
+  if (kana == Kana::ProlongMark)
+    // prolong is 'katakana', but it can appear in (non-standard) Hiragana.
+    done(kana, result, DoneType::Prolong);
+  else if (const auto repeat{Kana::findIterationMark(_source, kana)}; repeat) {
+    done(kana, result, DoneType::NewEmptyGroup);
+    result += repeat->get(_converter._target, _converter._flags, _prevKana);
+  } else if (Kana::find(_source, kana)) {
+    if (!processOne(kana, result)) _kanaGroup += kana;
+  } else {
+    // got non-kana so flush any letters and preserve new letter unconverted
+    done(kana, result, DoneType::NewEmptyGroup);
+    if (_converter.romajiTarget())
+      if (const auto c{toNarrowDelim(kana)}; c) {
+        result += c;
+        return;
+      }
+    result += kana;
   }
-  return result + processKana(kanaGroup, source, prevKana);
 }
 
-template <typename T>
-bool Converter::processOneKana(const T& done, CharType source,
-    const String& kana, const String& kanaGroup, State& state) const {
+void Converter::KanaState::finish(String& result) {
+  _converter.processKana(_kanaGroup, _source, _prevKana, result);
+  _kanaGroup.clear();
+  _state = State::New;
+}
+
+void Converter::KanaState::done(
+    StringView kana, String& result, DoneType dt, State ns) {
+  _converter.processKana(
+      _kanaGroup, _source, _prevKana, result, dt == DoneType::Prolong);
+  if (_converter.romajiTarget() && Kana::N.containsKana(_kanaGroup) &&
+      isAfterN(_source, kana))
+    result += Apostrophe;
+  if (dt == DoneType::NewGroup)
+    _kanaGroup = kana;
+  else
+    _kanaGroup.clear();
+  _state = ns;
+}
+
+bool Converter::KanaState::processOne(StringView kana, String& result) {
   if (Kana::SmallTsu.containsKana(kana))
     // getting a small tsu causes any stored kana to be processed
-    done(DoneType::NewGroup, State::SmallTsu);
+    done(kana, result, DoneType::NewGroup, State::SmallTsu);
   else if (Kana::N.containsKana(kana))
     // getting an 'n' causes any stored kana to be processed
-    done(DoneType::NewGroup, State::Done); // new group marked as 'Done'
+    done(kana, result, DoneType::NewGroup, State::Done); // new group is 'Done'
   else {
-    if (state != State::Done) {
-      if (smallKana(source).contains(kana)) {
+    if (_state != State::Done) {
+      if (isSmallKana(_source, kana)) {
         // a small letter (other than small tsu covered above) should cause
         // letters to be processed including the small letter so mark group as
         // done, but continue processing in case there's a 'prolong' mark.
-        state = State::Done;
+        _state = State::Done;
         return false;
       }
-      if (kanaGroup.size() <=
-          (state == State::SmallTsu ? Kana::OneKanaSize : 0))
+      if (_kanaGroup.size() <=
+          (_state == State::SmallTsu ? Kana::OneKanaSize : 0))
         // keep processing for a normal (non-n non-small) letter if it's the
         // first part of a group (or the group starts with a small tsu)
         return false;
     }
-    done();
+    done(kana, result);
   }
   return true;
 }
 
-String Converter::processKana(const String& kanaGroup, CharType source,
-    const Kana*& prevKana, bool prolong) const {
+void Converter::processKana(StringView kanaGroup, CharType source,
+    const Kana*& prevKana, String& result, bool prolong) const {
   if (!kanaGroup.empty()) {
     prevKana = nullptr;
-    auto& sourceMap{Kana::getMap(source)};
-    if (const auto i{sourceMap.find(kanaGroup)}; i != sourceMap.end())
-      return processKanaMacron(prolong, prevKana, i->second);
+    if (const auto k{Kana::find(source, kanaGroup)}; k)
+      return processKanaMacron(prolong, prevKana, k, result);
     // if letter group is an unknown, split it up and try processing each part
     if (kanaGroup.size() > Kana::OneKanaSize) {
       const auto firstKana{kanaGroup.substr(0, Kana::OneKanaSize)};
-      if (const auto i{sourceMap.find(kanaGroup.substr(Kana::OneKanaSize))};
-          i != sourceMap.end())
-        return romajiTarget() && Kana::SmallTsu.containsKana(firstKana) &&
-                       repeatingConsonants().contains(i->second->romaji()[0])
-                   ? processKanaMacron(prolong, prevKana, i->second, true)
-                   : processKana(firstKana, source, prevKana) +
-                         processKanaMacron(prolong, prevKana, i->second);
-      // return second part unconverted - this should be impossible by design
-      // since only Kana that exists in sourceMap are added to 'kanaGroup'
+      if (const auto k{
+              Kana::find(source, kanaGroup.substr(Kana::OneKanaSize))};
+          k) {
+        if (romajiTarget() && Kana::SmallTsu.containsKana(firstKana) &&
+            isRepeatingConsonant(k->romaji()[0]))
+          return processKanaMacron(prolong, prevKana, k, result, true);
+        processKana(firstKana, source, prevKana, result);
+        return processKanaMacron(prolong, prevKana, k, result);
+      }
+      // add second part unconverted - this should be impossible by design
+      // since only Kana that can be found are added to 'kanaGroup'
       // XCOV_EXCL_START
-      return processKana(firstKana, source, prevKana) +
-             kanaGroup.substr(Kana::OneKanaSize);
+      processKana(firstKana, source, prevKana, result);
+      result += kanaGroup.substr(Kana::OneKanaSize);
+      return;
       // XCOV_EXCL_STOP
     }
-  } else if (prolong)
+  } else if (prolong) {
     // a 'prolong mark' at the start of a group isn't valid so in this case just
-    // return the symbol unchanged
-    return Kana::ProlongMark;
-  return kanaGroup;
+    // add the symbol unchanged
+    result += Kana::ProlongMark;
+    return;
+  }
+  result += kanaGroup;
 }
 
-String Converter::processKanaMacron(
-    bool prolong, const Kana*& prevKana, const Kana* kana, bool sokuon) const {
-  const auto& result{sokuon ? kana->getSokuonRomaji(_flags) : get(*kana)};
+void Converter::processKanaMacron(bool prolong, const Kana*& prevKana,
+    const Kana* kana, String& result, bool sokuon) const {
+  if (sokuon)
+    result += _output->getSokuon(*kana);
+  else
+    result += get(*kana);
   if (prolong) {
-    if (_target != CharType::Romaji) return result + Kana::ProlongMark;
-    switch (result[result.size() - 1]) {
-    case 'a': return result.substr(0, result.size() - 1) + "ā";
-    case 'i': return result.substr(0, result.size() - 1) + "ī";
-    case 'u': return result.substr(0, result.size() - 1) + "ū";
-    case 'e': return result.substr(0, result.size() - 1) + "ē";
-    case 'o': return result.substr(0, result.size() - 1) + "ō";
+    if (_target != CharType::Romaji) {
+      result += Kana::ProlongMark;
+      return;
+    }
+    // replace the final vowel with its macron version
+    const auto macron{[&result](StringView vowel) {
+      result.pop_back();
+      result += vowel;
+    }};
+    switch (result.back()) {
+    case 'a': macron("ā"); break;
+    case 'i': macron("ī"); break;
+    case 'u': macron("ū"); break;
+    case 'e': macron("ē"); break;
+    case 'o': macron("ō"); break;
     default:
-      return result + Kana::ProlongMark; // shouldn't happen, return unconverted
+      result += Kana::ProlongMark; // shouldn't happen, add unconverted
     }
+    return;
   }
   prevKana = kana;
-  return result;
 }
 
-String Converter::toKana(const String& romajiInput) const {
-  String result, letters, letter;
-  for (Utf8Char s{romajiInput}; s.next(letter, false);)
-    if (isSingleByte(letter)) {
-      if (!isN(letter)) {
-        letters += letter;
-        processRomaji(letters, result);
-      } else if (letters.empty())
-        letters += letter;
-      else if (isN(letters))
-        // got two 'n's in a row so output one, but don't clear letters
-        result += getN();
-      else {
-        // error: partial romaji followed by n, output unconverted partial group
-        result += letters;
-        letters = letter; // 'n' starts a new group
-      }
-    } else if (!processRomajiMacron(letter, letters, result)) {
-      processRomaji(letters, result);
+void Converter::RomajiState::add(StringView letter, String& result) {
+  if (letter.size() != 1) {
+    if (!_converter.processRomajiMacron(letter, _letters, result)) {
+      _converter.processRomaji(_letters, result);
       result += letter;
     }
-  while (!letters.empty())
-    if (isN(letters)) {
-      result += getN(); // normal case for a word ending in 'n'
-      letters.clear();
+  } else if (const auto c{letter[0]}; c < ' ') {
+    // control characters (like newline) also end a word, but aren't converted
+    finish(result);
+    result += c;
+  } else if (isNarrowDelim(c)) {
+    finish(result);
+    if (c != Apostrophe && c != Dash &&
+        (c != ' ' || !(_converter._flags & ConvertFlags::RemoveSpaces)))
+      result += toWideDelim(c);
+  } else if (!isN(letter)) {
+    _letters += c;
+    _converter.processRomaji(_letters, result);
+  } else if (_letters.empty())
+    _letters += c;
+  else if (isN(_letters))
+    // got two 'n's in a row so output one, but don't clear letters
+    result += _converter.getN();
+  else {
+    // error: partial romaji followed by n, output unconverted partial group
+    result += _letters;
+    _letters = c; // 'n' starts a new group
+  }
+}
+
+void Converter::RomajiState::finish(String& result) {
+  while (!_letters.empty())
+    if (isN(_letters)) {
+      result += _converter.getN(); // normal case for a word ending in 'n'
+      _letters.clear();
     } else {
-      result += letters[0]; // error: output the unprocessed letter
-      letters = letters.substr(1);
-      processRomaji(letters, result);
+      result += _letters[0]; // error: output the unprocessed letter
+      _letters.erase(0, 1);
+      _converter.processRomaji(_letters, result);
     }
-  return result;
+}
+
+bool Converter::RomajiState::backspace() {
+  if (_letters.empty()) return false;
+  _letters.pop_back();
+  return true;
 }
 
 void Converter::processRomaji(String& letters, String& result) const {
-  auto& sourceMap{Kana::getMap(CharType::Romaji)};
-  String lower{toLower(letters)};
-  if (const auto i{sourceMap.find(lower)}; i != sourceMap.end()) {
-    result += get(*i->second);
+  if (const auto k{tokens().romajiTrie().find(letters)}; k) {
+    result += get(*k);
     letters.clear();
   } else if (letters.size() == Kana::RomajiStringMax) {
     // convert first letter to small tsu if letter repeats and is a valid
     // consonant (also allow 'tc' combination) otherwise output the first letter
     // unconverted since no valid romaji can be longer than 3 letters
-    result += lower[0] == 'n' ? getN()
-              : lower[0] == lower[1] || lower[0] == 't' && lower[1] == 'c'
-                  ? repeatingConsonants().contains(letters[0])
-                        ? getSmallTsu()
-                        : letters.substr(0, 1) // error: first letter not valid
-                  : letters.substr(0, 1);      // error: first letter not valid
-    letters = letters.substr(1);
+    const auto lower{[&letters](size_t i) {
+      return static_cast<char>(::tolower(letters[i]));
+    }};
+    const auto first{lower(0)}, second{lower(1)};
+    if (first == 'n')
+      result += getN();
+    else if ((first == second || (first == 't' && second == 'c')) &&
+             isRepeatingConsonant(first))
+      result += getSmallTsu();
+    else
+      result += letters[0]; // error: first letter not valid
+    letters.erase(0, 1);
     // try converting the shortened letters
     processRomaji(letters, result);
   }
 }
 
 bool Converter::processRomajiMacron(
-    const String& letter, String& letters, String& result) const {
-  static const std::map<String, std::pair<char, String>> Macrons{
-      {"ā", {'a', "あ"}}, {"ī", {'i', "い"}}, // GCOV_EXCL_LINE
-      {"ū", {'u', "う"}}, {"ē", {'e', "え"}}, {"ō", {'o', "お"}}};
-
-  if (const auto i{Macrons.find(letter)}; i != Macrons.end()) {
-    processRomaji(letters += i->second.first, result);
+    StringView letter, String& letters, String& result) const {
+  struct Macron final {
+    StringView macron;
+    char vowel;
+    StringView hiragana;
+  };
+  static constexpr std::array Macrons{Macron{"ā", 'a', "あ"},
+      Macron{"ī", 'i', "い"}, Macron{"ū", 'u', "う"}, Macron{"ē", 'e', "え"},
+      Macron{"ō", 'o', "お"}};
+
+  if (const auto i{std::find_if(Macrons.begin(), Macrons.end(),
+          [letter](auto& m) { return m.macron == letter; })};
+      i != Macrons.end()) {
+    processRomaji(letters += i->vowel, result);
     if (letters.empty())
       result +=
           hiraganaTarget() && hasValue(_flags & ConvertFlags::NoProlongMark)
-              ? i->second.second
+              ? i->hiragana
               : Kana::ProlongMark;
     else {
       // non-empty 'letters' (after the above call to 'processRomaji') can only
@@ -369,13 +670,293 @@ bool Converter::processRomajiMacron(
       // single vowel (above case would become 'vyい' for Hiragana target)
       letters.pop_back();
       result += letters;
-      processRomaji(letters = i->second.first, result);
+      processRomaji(letters = i->vowel, result);
     }
     return true;
   }
-  // not being found in 'Macrons' map can happen when processing Rōmaji input
+  // not being found in 'Macrons' can happen when processing Rōmaji input
   // and a non-macron multi-byte character is found (like Kana for example)
   return false;
 }
 
+// RomajiInput
+
+RomajiInput::RomajiInput(CharType target, ConvertFlags flags)
+    : _converter{target, flags}, _state{_converter} {
+  if (target == CharType::Romaji)
+    throw DomainError{"RomajiInput target must be Hiragana or Katakana"};
+}
+
+RomajiInput::Change RomajiInput::push(char c) {
+  if (toUChar(c) > MaxAscii) {
+    // wait for the rest of a multi-byte value - invalid UTF-8 is dropped (like
+    // Converter::convert) so a new start byte replaces any partial value and a
+    // continuation byte without a start byte is ignored
+    if ((toUChar(c) & TwoBits) != Bit1)
+      _partial = c;
+    else if (!_partial.empty())
+      _partial += c;
+    if (_partial.empty() || getMBUtf8Size(_partial) != _partial.size()) {
+      if (_partial.size() >= MaxMBSize) _partial.clear();
+      return {};
+    }
+  } else
+    _partial.clear();
+  const auto start{removePending()};
+  _state.add(
+      _partial.empty() ? StringView{&c, 1} : StringView{_partial}, _text);
+  _partial.clear();
+  return appendPending(start);
+}
+
+RomajiInput::Change RomajiInput::backspace() {
+  if (!_partial.empty()) {
+    _partial.clear(); // partial values aren't part of text() so just drop them
+    return {};
+  }
+  auto start{_text.size()};
+  if (_state.backspace())
+    --start;
+  else if (start)
+    // move back to the start of the last UTF-8 value
+    while (--start && (toUChar(_text[start]) & TwoBits) == Bit1 &&
+           _text.size() - start < MaxMBSize)
+      ;
+  _erased = StringView{_text}.substr(start);
+  _text.resize(start);
+  return {_erased, {}};
+}
+
+RomajiInput::Change RomajiInput::flush() {
+  _partial.clear();
+  const auto start{removePending()};
+  _state.finish(_text);
+  return appendPending(start);
+}
+
+void RomajiInput::clear() {
+  while (_state.backspace())
+    ;
+  _text.clear();
+  _partial.clear();
+  _erased.clear();
+}
+
+StringView RomajiInput::committed() const {
+  return StringView{_text}.substr(0, _text.size() - pending().size());
+}
+
+size_t RomajiInput::removePending() {
+  const auto start{committed().size()};
+  _erased = StringView{_text}.substr(start);
+  _text.resize(start);
+  return start;
+}
+
+RomajiInput::Change RomajiInput::appendPending(size_t start) {
+  _text += _state.letters();
+  // pending letters are Ascii so comparing bytes can't split a UTF-8 value
+  const auto added{StringView{_text}.substr(start)};
+  const auto same{static_cast<size_t>(
+      std::mismatch(_erased.begin(), _erased.end(), added.begin(), added.end())
+          .first -
+      _erased.begin())};
+  return {StringView{_erased}.substr(same), added.substr(same)};
+}
+
+void convertKana(StringView input, CharType source, CharType target,
+    ConvertFlags flags, String& out) {
+  // a Converter only holds target, flags and a pointer to constant output
+  // functions so constructing a local one is cheap (and nothing is shared)
+  Converter{target, flags}.convert(source, input, out);
+}
+
+void convertKana(
+    StringView input, CharType target, ConvertFlags flags, String& out) {
+  Converter{target, flags}.convert(input, out);
+}
+
+// ConverterStream
+
+ConverterStream::ConverterStream(const Converter& c) {
+  // chain states for the non-target types so input is only scanned once, Kana
+  // states come first followed by Rōmaji (if it's not the target), i.e., the
+  // chain is Hiragana → Katakana for a Rōmaji target and Katakana → Rōmaji
+  // for a Hiragana target
+  if (c.romajiTarget()) {
+    _first.emplace(c, CharType::Hiragana);
+    _second.emplace(c, CharType::Katakana);
+  } else {
+    _first.emplace(
+        c, c.hiraganaTarget() ? CharType::Katakana : CharType::Hiragana);
+    _romaji.emplace(c);
+  }
+}
+
+ConverterStream::ConverterStream(const Converter& c, CharType source) {
+  if (source == c.target()) return; // input is passed through unchanged
+  if (source == CharType::Romaji)
+    _romaji.emplace(c);
+  else
+    _first.emplace(c, source);
+}
+
+void ConverterStream::feed(StringView chunk, String& out) {
+  if (!_pending.empty()) {
+    _pending += chunk;
+    const auto split{splitPoint(_pending)};
+    process(StringView{_pending}.substr(0, split), out);
+    _pending.erase(0, split);
+  } else {
+    const auto split{splitPoint(chunk)};
+    process(chunk.substr(0, split), out);
+    _pending = chunk.substr(split);
+  }
+}
+
+void ConverterStream::finish(String& out) {
+  process(_pending, out);
+  _pending.clear();
+  if (_second)
+    kanji_tools::finish(*_first, *_second, out, _buffer);
+  else if (_romaji && _first)
+    kanji_tools::finish(*_first, *_romaji, out, _buffer);
+  else if (_first)
+    _first->finish(out);
+  else if (_romaji)
+    _romaji->finish(out);
+}
+
+void ConverterStream::finish(StringView chunk, String& out) {
+  if (_pending.empty())
+    process(chunk, out);
+  else
+    _pending += chunk;
+  finish(out);
+}
+
+void ConverterStream::convert(
+    std::istream& in, std::ostream& os, size_t chunkSize) {
+  String chunk(chunkSize, '\0'), out;
+  while (in.read(chunk.data(), static_cast<std::streamsize>(chunkSize)) ||
+         in.gcount()) {
+    feed(StringView{chunk}.substr(0, static_cast<size_t>(in.gcount())), out);
+    os << out;
+    out.clear();
+  }
+  finish(out);
+  os << out;
+}
+
+std::vector<size_t> ConverterStream::splitPoints(
+    StringView input, size_t partSize, bool complete) {
+  static constexpr std::array KanaTypes{CharType::Hiragana, CharType::Katakana};
+  using Resolved = std::array<bool, KanaTypes.size()>;
+  // candidates are positions waiting for a Kana of each type (before getting an
+  // iteration mark of that type). Older candidates are always at least as
+  // resolved as newer ones so they are accepted (or rejected) in order. A type
+  // is already resolved if no Kana of that type has been seen yet since there
+  // isn't any previous Kana to repeat in that case.
+  std::deque<std::pair<size_t, Resolved>> candidates;
+  Resolved seen{};
+  std::vector<size_t> result;
+  const auto isResolved{[](const Resolved& r) {
+    return std::all_of(r.begin(), r.end(), std::identity{});
+  }};
+  const auto isBoundary{[](char c) {
+    return toUChar(c) < ' ' || Converter::isNarrowDelim(c);
+  }};
+  const auto minSize{std::max(partSize, size_t{1})};
+  for (size_t i{}, next{minSize}; i < input.size();)
+    if (!candidates.empty() && isResolved(candidates.front().second)) {
+      result.emplace_back(candidates.front().first);
+      candidates.pop_front();
+    } else if (toUChar(input[i]) <= MaxAscii) {
+      if (i >= next && isBoundary(input[i - 1])) {
+        candidates.emplace_back(i, Resolved{!seen[0], !seen[1]});
+        next = i + minSize;
+      }
+      ++i;
+    } else if ((candidates.empty() && isResolved(seen)) ||
+               input.size() - i < VarSelectorSize)
+      ++i;
+    else {
+      const auto kana{input.substr(i, VarSelectorSize)};
+      // Kana followed by a modifier might not be found by KanaState so it
+      // doesn't resolve any candidates (this is just being conservative)
+      const auto modified{input.size() - i >= VarSelectorSize * 2 &&
+                          (Utf8Char::isVariationSelector(kana.end()) ||
+                              Utf8Char::isCombiningMark(kana.end()))};
+      for (size_t j{}; j < KanaTypes.size(); ++j)
+        if (Kana::findIterationMark(KanaTypes[j], kana)) {
+          while (!candidates.empty() && !candidates.back().second[j])
+            candidates.pop_back();
+          // next candidate must be at least 'minSize' after the previous one
+          next = (candidates.empty() ? result.empty() ? 0 : result.back()
+                                     : candidates.back().first) +
+                 minSize;
+        } else if (Kana::find(KanaTypes[j], kana)) {
+          seen[j] = true;
+          if (!modified)
+            for (auto c{candidates.rbegin()};
+                 c != candidates.rend() && !c->second[j]; ++c)
+              c->second[j] = true;
+        }
+      // any valid Kana is 3 bytes, but only skip 1 byte for anything else to
+      // stay in sync with invalid UTF-8 (continuation bytes are never Ascii)
+      i += Kana::find(CharType::Hiragana, kana) ||
+                   Kana::find(CharType::Katakana, kana)
+               ? VarSelectorSize
+               : 1;
+    }
+  // the end of input means there can't be any following iteration marks
+  for (auto& i : candidates)
+    if (complete || isResolved(i.second)) result.emplace_back(i.first);
+  return result;
+}
+
+size_t ConverterStream::splitPoint(StringView s) {
+  // if the last character is followed by variation selectors or combining
+  // marks then also hold them back (and the character they modify) - this
+  // includes a trailing partial 3 byte sequence since it could become one
+  const auto isModifier{[s](size_t i) {
+    if (s.size() - i < VarSelectorSize)
+      return (toUChar(s[i]) & FourBits) == ThreeBits;
+    return Utf8Char::isVariationSelector(s.data() + i) ||
+           Utf8Char::isCombiningMark(s.data() + i);
+  }};
+  // size of the sequence started by 'c' (0 for a continuation byte)
+  const auto sequenceSize{[](char c) -> size_t {
+    const auto x{toUChar(c)};
+    if ((x & TwoBits) == Bit1) return 0;
+    if ((x & ThreeBits) == TwoBits) return MinMBSize;
+    if ((x & FourBits) == ThreeBits) return VarSelectorSize;
+    return (x & FiveBits) == FourBits ? MaxMBSize : 1;
+  }};
+  for (auto i{s.size()}; i;) {
+    // move back to the start of a sequence and if there are more continuation
+    // bytes than it can hold then the extra ones are invalid no matter what
+    // comes next (and they end the previous character) so split after them
+    const auto end{i};
+    while (--i && (toUChar(s[i]) & TwoBits) == Bit1)
+      ;
+    if (end - i > sequenceSize(s[i])) return end;
+    if (!isModifier(i)) return i;
+  }
+  return 0;
+}
+
+void ConverterStream::process(StringView input, String& out) {
+  if (_second)
+    kanji_tools::feed(*_first, *_second, input, out, _buffer);
+  else if (_romaji && _first)
+    kanji_tools::feed(*_first, *_romaji, input, out, _buffer);
+  else if (_first)
+    kanji_tools::feed(*_first, input, out);
+  else if (_romaji)
+    kanji_tools::feed(*_romaji, input, out);
+  else
+    out += input;
+}
+
 } // namespace kanji_tools
@@ -1,15 +1,31 @@
 #include <kt_kana/DisplaySize.h>
 
+#include <cstring>
+
 namespace kanji_tools {
 
 size_t displaySize(const CodeString& s) {
   size_t result{};
-  for (const auto i : s)
-    if (i && !isNonSpacing(i)) result += inRange(i, WideBlocks) ? 2 : 1;
+  for (const auto i : s) result += displaySize(i);
   return result;
 }
 
-size_t displaySize(const char* s) { return displaySize(fromUtf8(s)); }
+size_t displaySize(const char* s) {
+  size_t result{};
+  if (!s) return result;
+  for (StringView v{s, std::strlen(s)}; !v.empty();) {
+    // Ascii is always narrow so count whole runs at once (using block scanning)
+    const auto ascii{asciiPrefixSize(v)};
+    result += ascii;
+    v.remove_prefix(ascii);
+    if (!v.empty()) {
+      const auto i{Utf8View{v}.begin()};
+      result += displaySize(*i);
+      v.remove_prefix(i.size());
+    }
+  }
+  return result;
+}
 
 size_t displaySize(const String& s) { return displaySize(s.c_str()); }
 
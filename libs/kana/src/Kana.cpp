@@ -1,12 +1,122 @@
 #include <kt_kana/Kana.h>
 #include <kt_utils/UnicodeBlock.h>
 
-#include <cassert>
+#include <algorithm>
+#include <stdexcept>
 
 namespace kanji_tools {
 
 namespace {
 
+using RomajiForms = std::array<StringView, Kana::RomajiForms>;
+
+/// return Rōmaji values for each form (Hepburn is preferred over Kunrei when
+/// both flags are set and forms without a special value use `romaji`)
+[[nodiscard]] constexpr RomajiForms makeRomajiForms(StringView romaji,
+    StringView hepburn, StringView kunrei, const Kana::RomajiVariants& v) {
+  RomajiForms result;
+  for (size_t i{}; i < Kana::RomajiForms; ++i) {
+    const auto flags{static_cast<ConvertFlags>(i)};
+    result[i] = hasValue(flags & ConvertFlags::Hepburn) && !hepburn.empty()
+                    ? hepburn
+                : hasValue(flags & ConvertFlags::Kunrei) && v.kunrei()
+                    ? v.list()[0]
+                : hasValue(flags & ConvertFlags::Kunrei) && !kunrei.empty()
+                    ? kunrei
+                    : romaji;
+  }
+  return result;
+}
+
+/// return sokuon values for `forms`, i.e., repeat the first letter (but use 't'
+/// for 'c' so 'chi' becomes 'tchi')
+[[nodiscard]] constexpr auto makeSokuon(const RomajiForms& forms) {
+  std::array<std::array<char, Kana::RomajiStringMax + 1>, Kana::RomajiForms>
+      result{};
+  for (size_t i{}; i < Kana::RomajiForms; ++i) {
+    const auto r{forms[i]};
+    result[i][0] = r[0] == 'c' ? 't' : r[0];
+    std::copy(r.begin(), r.end(), result[i].begin() + 1);
+  }
+  return result;
+}
+
+} // namespace
+
+// Kana and related class ctor template definitions can be in the .cpp file
+// since Kana objects are only created in this TU (Translation Unit). They are
+// defined before the lists below so the lists can be 'constexpr'.
+
+template <size_t R>
+constexpr Kana::RomajiVariants::RomajiVariants(CharArray<R> r, bool kunrei)
+    : _list{r}, _size{1}, _kunrei{kunrei} {
+  check<R>();
+}
+
+template <size_t R>
+constexpr Kana::RomajiVariants::RomajiVariants(
+    CharArray<R> r1, CharArray<R> r2, bool kunrei)
+    : _list{r1, r2}, _size{2}, _kunrei{kunrei} {
+  check<R>();
+}
+
+template <size_t R>
+constexpr Kana::RomajiVariants::RomajiVariants(
+    CharArray<R> r1, RMax r2, RMax r3)
+    : _list{r1, r2, r3}, _size{MaxVariants} {
+  check<R>();
+}
+
+template <size_t R, size_t A>
+constexpr Kana::Kana(
+    CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana)
+    : Kana{romaji, hiragana, katakana, {}, {}, {}} {}
+
+template <size_t R, size_t A, size_t H, size_t K>
+constexpr Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana,
+    CharArray<A> katakana, CharArray<H> hepburn, CharArray<K> kunrei)
+    : Kana{romaji, hiragana, katakana, hepburn, kunrei, {}} {
+  static_assert(H <= RomajiArrayMax && K <= RomajiArrayMax);
+  if constexpr (A == OneKanaArraySize)
+    static_assert(H >= RomajiArrayMin && K >= RomajiArrayMin);
+  else {
+    // all digraphs have Rōmaji of at least 2 characters
+    static_assert(A == TwoKanaArraySize);
+    static_assert(H > RomajiArrayMin && K > RomajiArrayMin);
+  }
+}
+
+template <size_t R, size_t A>
+constexpr Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana,
+    CharArray<A> katakana, const RomajiVariants& variants)
+    : Kana{romaji, hiragana, katakana, {}, {}, variants} {}
+
+template <size_t R, size_t A>
+constexpr Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana,
+    CharArray<A> katakana, StringView hepburn, StringView kunrei,
+    const RomajiVariants& variants)
+    : _romaji{romaji}, _hiragana{hiragana}, _katakana{katakana},
+      _hepburn{hepburn}, _kunrei{kunrei}, _variants{variants},
+      _romajiForms{makeRomajiForms(romaji, hepburn, kunrei, variants)},
+      _sokuon{makeSokuon(_romajiForms)} {
+  static_assert(R <= RomajiArrayMax);
+  // Hiragana and Katakana must be the same size (3 or 6) and also check that
+  // Rōmaji is at least 1 character for a monograph or 2 for a digraph
+  static_assert(A == OneKanaArraySize && R >= RomajiArrayMin ||
+                A == TwoKanaArraySize && R > RomajiArrayMin);
+}
+
+template <typename... T>
+constexpr DakutenKana::DakutenKana(Kana&& dakuten, T&&... t)
+    : Kana{std::forward<T>(t)...}, _dakuten{std::move(dakuten), *this} {}
+
+template <typename... T>
+constexpr HanDakutenKana::HanDakutenKana(Kana&& hanDakuten, T&&... t)
+    : DakutenKana{std::forward<T>(t)...}, _hanDakuten{
+                                              std::move(hanDakuten), *this} {}
+
+namespace {
+
 namespace kana_lists {
 
 // define some short type aliases to help create arrays of Kana below
@@ -17,7 +127,7 @@ using V = Kana::RomajiVariants;
 // 'han-dakuten' versions and regularly used digraphs (normal Kana followed by a
 // small Kana 'vowel', 'y' or 'wa'). See comments for 'Kana' class for a
 // description of the fields.
-const std::array KanaList{// --- あ 行 ---
+constexpr std::array KanaList{// --- あ 行 ---
     K{"a", "あ", "ア"}, K{"na", "な", "ナ"}, K{"ma", "ま", "マ"},
     K{"ya", "や", "ヤ"}, K{"ra", "ら", "ラ"}, K{"wa", "わ", "ワ"},
     // あ Digraphs
@@ -71,7 +181,7 @@ const std::array KanaList{// --- あ 行 ---
 
 using D = DakutenKana;
 // 'DakutenKanaList' holds Kana that have a 'dakuten' version (but not 'h' row)
-const std::array DakutenKanaList{// --- あ 行 ---
+constexpr std::array DakutenKanaList{// --- あ 行 ---
     D{K{"ga", "が", "ガ"}, "ka", "か", "カ"},
     D{K{"za", "ざ", "ザ"}, "sa", "さ", "サ"},
     D{K{"da", "だ", "ダ"}, "ta", "た", "タ"},
@@ -139,7 +249,7 @@ const std::array DakutenKanaList{// --- あ 行 ---
 using H = HanDakutenKana;
 // 'HanDakutenKanaList' has Kana that have both a 'dakuten' and a 'han-dakuten'
 // version (so just the 'h' row)
-const std::array HanDakutenKanaList{
+constexpr std::array HanDakutenKanaList{
     H{K{"pa", "ぱ", "パ"}, K{"ba", "ば", "バ"}, "ha", "は", "ハ"},
     H{K{"pi", "ぴ", "ピ"}, K{"bi", "び", "ビ"}, "hi", "ひ", "ヒ"},
     H{K{"pu", "ぷ", "プ"}, K{"bu", "ぶ", "ブ"}, "fu", "ふ", "フ",
@@ -163,31 +273,173 @@ const std::array HanDakutenKanaList{
 using kana_lists::KanaList, kana_lists::DakutenKanaList,
     kana_lists::HanDakutenKanaList;
 
+/// call `f` for every Kana object (including accented ones)
+template <typename F> constexpr void forEachKana(F f) {
+  for (auto& i : KanaList) f(i);
+  for (auto& i : DakutenKanaList) {
+    f(i);
+    f(*i.dakuten());
+  }
+  for (auto& i : HanDakutenKanaList) {
+    f(i);
+    f(*i.dakuten());
+    f(*i.hanDakuten());
+  }
+}
+
+/// call `f` for each key of `k` for a map of type `t` (Rōmaji maps have keys
+/// for Rōmaji as well as all Rōmaji variants)
+template <CharType T, typename F>
+constexpr void forEachKey(const Kana& k, F f) {
+  if constexpr (T == CharType::Romaji) {
+    f(k.romaji());
+    for (auto& i : k.romajiVariants()) f(i);
+  } else
+    f(T == CharType::Hiragana ? k.hiragana() : k.katakana());
+}
+
+/// return a sorted array of (key, Kana) entries for map type `T`, the array
+/// is built at compile time so the maps don't need any start-up construction
+template <CharType T> consteval auto makeMapEntries() {
+  constexpr auto Size{[] {
+    size_t result{};
+    forEachKana([&result](auto& k) {
+      forEachKey<T>(k, [&result](StringView) { ++result; });
+    });
+    return result;
+  }()};
+  std::array<Kana::Map::Entry, Size> result{};
+  size_t pos{};
+  forEachKana([&result, &pos](const Kana& k) {
+    forEachKey<T>(k, [&](StringView key) { result[pos++] = {key, &k}; });
+  });
+  std::sort(result.begin(), result.end(),
+      [](auto& x, auto& y) { return x.first < y.first; });
+  return result;
+}
+
+constexpr auto RomajiEntries{makeMapEntries<CharType::Romaji>()};
+constexpr auto HiraganaEntries{makeMapEntries<CharType::Hiragana>()};
+constexpr auto KatakanaEntries{makeMapEntries<CharType::Katakana>()};
+
+/// return true if all keys in `entries` are unique (used to verify that each
+/// Kana (and Rōmaji variant) only appears once in the lists above)
+[[nodiscard]] consteval bool uniqueKeys(auto& entries) {
+  return std::adjacent_find(entries.begin(), entries.end(),
+             [](auto& x, auto& y) { return x.first == y.first; }) ==
+         entries.end();
+}
+
+static_assert(uniqueKeys(RomajiEntries));
+static_assert(uniqueKeys(HiraganaEntries));
+static_assert(uniqueKeys(KatakanaEntries));
+
+constexpr Code HiraganaStart{Kana::CompositionStart}, KatakanaStart{U'\x30a0'};
+constexpr size_t KanaBlockSize{KatakanaStart - HiraganaStart},
+    SmallKanaSlots{10}; // 9 small Kana that can end a digraph plus 'none'
+
+/// 'slots' of small Kana (indexed by offset from the start of their block) -
+/// Hiragana and Katakana blocks have the same layout so only one is needed
+constexpr auto SmallKanaSlot{[] {
+  std::array<uint8_t, KanaBlockSize> result{};
+  uint8_t slot{};
+  for (const auto c :
+      {U'ぁ', U'ぃ', U'ぅ', U'ぇ', U'ぉ', U'ゃ', U'ゅ', U'ょ', U'ゎ'})
+    result[c - HiraganaStart] = ++slot;
+  return result;
+}()};
+static_assert(SmallKanaSlot[U'ゎ' - HiraganaStart] == SmallKanaSlots - 1);
+
+/// return first Unicode value of the block for Hiragana or Katakana `t`
+[[nodiscard]] constexpr Code blockStart(CharType t) {
+  return t == CharType::Hiragana ? HiraganaStart : KatakanaStart;
+}
+
+static_assert(Kana::kanaCode("あ") == U'あ' && Kana::kanaCode("ヾ") == U'ヾ');
+static_assert(!Kana::kanaCode("\xe3\x81\xe3") && !Kana::kanaCode("abc"));
+
+using CompositionTable =
+    std::array<StringView, Kana::CompositionEnd - Kana::CompositionStart + 1>;
+
+/// return a table indexed by 'Code - CompositionStart' holding views of the
+/// 'dakuten' (or 'han-dakuten' if `dakuten` is false) version of each Kana
+[[nodiscard]] consteval CompositionTable makeComposition(bool dakuten) {
+  CompositionTable result{};
+  const auto add{[&result, dakuten](auto& entries, auto get) {
+    for (auto& i : entries)
+      if (i.first.size() == Kana::OneKanaSize)
+        if (auto* k{dakuten ? i.second->dakuten() : i.second->hanDakuten()};
+            k)
+          result[Kana::kanaCode(i.first) - Kana::CompositionStart] = get(*k);
+  }};
+  add(HiraganaEntries, [](auto& k) { return k.hiragana(); });
+  add(KatakanaEntries, [](auto& k) { return k.katakana(); });
+  return result;
+}
+
+constexpr auto DakutenComposition{makeComposition(true)},
+    HanDakutenComposition{makeComposition(false)};
+
+using KanaTable =
+    std::array<std::array<const Kana*, SmallKanaSlots>, KanaBlockSize>;
+
+/// return table of Kana for `t` indexed by (first Kana, small Kana slot)
+template <CharType T> consteval KanaTable makeKanaTable(auto& entries) {
+  KanaTable result{};
+  constexpr auto Start{blockStart(T)};
+  for (auto& i : entries) {
+    // out of range values cause an exception (so a compile error) in 'at'
+    const auto first{Kana::kanaCode(i.first) - Start};
+    size_t slot{};
+    if (i.first.size() == Kana::TwoKanaSize)
+      if (!(slot = SmallKanaSlot.at(
+                Kana::kanaCode(i.first.substr(Kana::OneKanaSize)) - Start)))
+        throw std::domain_error{"second Kana must be small"};
+    result.at(first)[slot] = i.second;
+  }
+  return result;
+}
+
+constexpr auto HiraganaTable{makeKanaTable<CharType::Hiragana>(
+    HiraganaEntries)},
+    KatakanaTable{makeKanaTable<CharType::Katakana>(KatakanaEntries)};
+
+[[nodiscard]] StringView compose(Code c, bool dakuten) {
+  if (c < Kana::CompositionStart || c > Kana::CompositionEnd) return {};
+  return (dakuten ? DakutenComposition
+                  : HanDakutenComposition)[c - Kana::CompositionStart];
+}
+
 } // namespace
 
-const Kana::Map Kana::RomajiMap{Kana::populate(CharType::Romaji)},
-    Kana::HiraganaMap{Kana::populate(CharType::Hiragana)},
-    Kana::KatakanaMap{Kana::populate(CharType::Katakana)};
+constexpr Kana::Map Kana::RomajiMap{RomajiEntries},
+    Kana::HiraganaMap{HiraganaEntries}, Kana::KatakanaMap{KatakanaEntries};
 
-const Kana::IterationMark Kana::RepeatPlain{"ゝ", "ヽ", false},
+constexpr Kana::IterationMark Kana::RepeatPlain{"ゝ", "ヽ", false},
     Kana::RepeatAccented{"ゞ", "ヾ", true};
 
-const Kana& Kana::SmallTsu{KanaList[KanaList.size() - 2]};
-const Kana& Kana::N{KanaList[KanaList.size() - 1]};
+constexpr const Kana& Kana::SmallTsu{KanaList[KanaList.size() - 2]};
+constexpr const Kana& Kana::N{KanaList[KanaList.size() - 1]};
 
-bool Kana::IterationMark::matches(CharType t, const String& s) const {
+const Kana* Kana::Map::find(StringView key) const {
+  const auto i{std::lower_bound(_list.begin(), _list.end(), key,
+      [](auto& entry, StringView k) { return entry.first < k; })};
+  return i != _list.end() && i->first == key ? i->second : nullptr;
+}
+
+bool Kana::IterationMark::matches(CharType t, StringView s) const {
   return t == CharType::Hiragana && _hiragana == s ||
          t == CharType::Katakana && _katakana == s;
 }
 
-const String& Kana::IterationMark::get(
+StringView Kana::IterationMark::get(
     CharType target, ConvertFlags flags, const Kana* prevKana) const {
   switch (target) {
   case CharType::Hiragana: return _hiragana;
   case CharType::Katakana: return _katakana;
   case CharType::Romaji: break;
   }
-  if (!prevKana) return emptyString();
+  if (!prevKana) return {};
   const Kana* k{prevKana};
   if (_dakuten) {
     if (const auto accented{prevKana->dakuten()}; accented) k = accented;
@@ -196,19 +448,8 @@ const String& Kana::IterationMark::get(
   return k->getRomaji(flags);
 }
 
-Kana::IterationMark::IterationMark(CharArray<OneKanaArraySize> hiragana,
-    CharArray<OneKanaArraySize> katakana, bool dakuten)
-    : _hiragana{hiragana}, _katakana{katakana}, _dakuten{dakuten} {
-  validate();
-}
-
-void Kana::IterationMark::validate() const {
-  assert(isAllHiragana(_hiragana));
-  assert(isAllKatakana(_katakana));
-}
-
 const Kana::IterationMark* Kana::findIterationMark(
-    CharType source, const String& kana) {
+    CharType source, StringView kana) {
   if (RepeatPlain.matches(source, kana)) return &RepeatPlain;
   if (RepeatAccented.matches(source, kana)) return &RepeatAccented;
   return {};
@@ -224,32 +465,54 @@ const Kana::Map& Kana::getMap(CharType t) {
 }
 
 Kana::OptString Kana::findDakuten(const String& s) {
-  auto i{HiraganaMap.find(s)};
-  if (i != HiraganaMap.end()) return i->second->dakuten(CharType::Hiragana);
-  i = KatakanaMap.find(s);
-  return i != KatakanaMap.end() ? i->second->dakuten(CharType::Katakana)
-                                : EmptyOptString;
+  if (auto* k{HiraganaMap.find(s)}; k) return k->dakuten(CharType::Hiragana);
+  if (auto* k{KatakanaMap.find(s)}; k) return k->dakuten(CharType::Katakana);
+  return EmptyOptString;
 }
 
 Kana::OptString Kana::findHanDakuten(const String& s) {
-  auto i{HiraganaMap.find(s)};
-  if (i != HiraganaMap.end()) return i->second->hanDakuten(CharType::Hiragana);
-  i = KatakanaMap.find(s);
-  return i != KatakanaMap.end() ? i->second->hanDakuten(CharType::Katakana)
-                                : EmptyOptString;
+  if (auto* k{HiraganaMap.find(s)}; k) return k->hanDakuten(CharType::Hiragana);
+  if (auto* k{KatakanaMap.find(s)}; k) return k->hanDakuten(CharType::Katakana);
+  return EmptyOptString;
 }
 
-const Kana* Kana::dakuten() const { return nullptr; }
-const Kana* Kana::hanDakuten() const { return nullptr; }
-const Kana* Kana::plain() const { return nullptr; }
+StringView Kana::composeDakuten(Code c) { return compose(c, true); }
+
+StringView Kana::composeHanDakuten(Code c) { return compose(c, false); }
+
+const Kana* Kana::find(CharType source, Code first, Code second) {
+  if (source == CharType::Romaji) return {};
+  const auto start{blockStart(source)};
+  // subtracting wraps around for values below 'start' so one check is enough
+  const size_t f{first - start};
+  if (f >= KanaBlockSize) return {};
+  size_t slot{};
+  if (second) {
+    const size_t s{second - start};
+    if (s >= KanaBlockSize || !(slot = SmallKanaSlot[s])) return {};
+  }
+  auto& table{source == CharType::Hiragana ? HiraganaTable : KatakanaTable};
+  return table[f][slot];
+}
+
+const Kana* Kana::find(CharType source, StringView s) {
+  switch (s.size()) {
+  case OneKanaSize: return find(source, kanaCode(s));
+  case TwoKanaSize:
+    return find(source, kanaCode(s.substr(0, OneKanaSize)),
+        kanaCode(s.substr(OneKanaSize)));
+  default: return {};
+  }
+}
 
 Kana::OptString Kana::dakuten(CharType t) const {
-  if (const auto i{dakuten()}; i) return i->get(t, ConvertFlags::None);
+  if (const auto i{dakuten()}; i) return String{i->get(t, ConvertFlags::None)};
   return EmptyOptString;
 }
 
 Kana::OptString Kana::hanDakuten(CharType t) const {
-  if (const auto i{hanDakuten()}; i) return i->get(t, ConvertFlags::None);
+  if (const auto i{hanDakuten()}; i)
+    return String{i->get(t, ConvertFlags::None)};
   return EmptyOptString;
 }
 
@@ -269,20 +532,7 @@ bool Kana::isHanDakuten() const {
   return false;
 }
 
-const String& Kana::getRomaji(ConvertFlags flags) const {
-  return hasValue(flags & ConvertFlags::Hepburn) && _hepburn ? *_hepburn
-         : hasValue(flags & ConvertFlags::Kunrei) && kunreiVariant()
-             ? romajiVariants()[0]
-         : hasValue(flags & ConvertFlags::Kunrei) && _kunrei ? *_kunrei
-                                                             : _romaji;
-}
-
-String Kana::getSokuonRomaji(ConvertFlags flags) const {
-  auto& r{getRomaji(flags)};
-  return (r[0] == 'c' ? 't' : r[0]) + r;
-}
-
-const String& Kana::get(CharType t, ConvertFlags flags) const {
+StringView Kana::get(CharType t, ConvertFlags flags) const {
   switch (t) {
   case CharType::Romaji: return getRomaji(flags);
   case CharType::Hiragana: return _hiragana;
@@ -291,7 +541,7 @@ const String& Kana::get(CharType t, ConvertFlags flags) const {
   __builtin_unreachable(); // stop gcc 'reaches end' warning XCOV_EXCL_LINE
 }
 
-bool Kana::containsKana(const String& s) const {
+bool Kana::containsKana(StringView s) const {
   return s == _hiragana || s == _katakana;
 }
 
@@ -301,126 +551,4 @@ bool Kana::operator==(const Kana& rhs) const {
   return _romaji == rhs._romaji;
 }
 
-void Kana::validate() const {
-  for ([[maybe_unused]] auto& i : romajiVariants()) assert(isAllSingleByte(i));
-  assert(isAllSingleByte(_romaji));
-  assert(isAllHiragana(_hiragana));
-  assert(isAllKatakana(_katakana));
-}
-
-Kana::Map Kana::populate(CharType t) {
-  Kana::Map result;
-  size_t duplicates{};
-  const auto insert{[&result, &duplicates, t](auto& k, auto& v) {
-    if (const auto i{result.emplace(k, &v)}; !i.second) {
-      // XCOV_EXCL_START: print all failures and then exit via an 'assert' below
-      std::cerr << "key '" << k << "' already in " << toString(t)
-                << " map: " << i.first->second << '\n';
-      ++duplicates; // NOLINT
-      // XCOV_EXCL_STOP
-    }
-  }};
-  const auto processKana{[&insert, t](auto& k) {
-    switch (t) {
-    case CharType::Romaji:
-      insert(k.romaji(), k);
-      for (auto& i : k.romajiVariants()) insert(i, k);
-      break;
-    case CharType::Hiragana: insert(k.hiragana(), k); break;
-    case CharType::Katakana: insert(k.katakana(), k); break;
-    }
-  }};
-  // process lists (inserting into 'result')
-  for (auto& i : KanaList) processKana(i);
-  for (auto& i : DakutenKanaList) {
-    processKana(i);
-    processKana(*i.dakuten());
-  }
-  for (auto& i : HanDakutenKanaList) {
-    processKana(i);
-    processKana(*i.dakuten());
-    processKana(*i.hanDakuten());
-  }
-  assert(duplicates == 0);
-  return result;
-}
-
-const Kana* DakutenKana::dakuten() const { return &_dakuten; }
-
-DakutenKana::AccentedKana::AccentedKana(Kana&& k, const Kana& p)
-    : Kana{std::move(k)}, _plain{p} {}
-
-const Kana* DakutenKana::AccentedKana::plain() const { return &_plain; }
-
-const Kana* HanDakutenKana::hanDakuten() const { return &_hanDakuten; }
-
-// Kana and related class ctor template definitions can be in the .cpp file
-// since Kana objects are only created in this TU (Translation Unit)
-
-template <size_t R>
-Kana::RomajiVariants::RomajiVariants(CharArray<R> r, bool kunrei)
-    : _list{r}, _kunrei{kunrei} {
-  check<R>();
-}
-
-template <size_t R>
-Kana::RomajiVariants::RomajiVariants(
-    CharArray<R> r1, CharArray<R> r2, bool kunrei)
-    : _list{r1, r2}, _kunrei{kunrei} {
-  check<R>();
-}
-
-template <size_t R>
-Kana::RomajiVariants::RomajiVariants(CharArray<R> r1, RMax r2, RMax r3)
-    : _list{r1, r2, r3} {
-  check<R>();
-}
-
-template <size_t R, size_t A>
-Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana)
-    : Kana{romaji, hiragana, katakana, {}, {}, {}} {}
-
-template <size_t R, size_t A, size_t H, size_t K>
-Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana,
-    CharArray<H> hepburn, CharArray<K> kunrei)
-    : Kana{romaji, hiragana, katakana, hepburn, kunrei, {}} {
-  static_assert(H <= RomajiArrayMax && K <= RomajiArrayMax);
-  if constexpr (A == OneKanaArraySize)
-    static_assert(H >= RomajiArrayMin && K >= RomajiArrayMin);
-  else {
-    // all digraphs have Rōmaji of at least 2 characters
-    static_assert(A == TwoKanaArraySize);
-    static_assert(H > RomajiArrayMin && K > RomajiArrayMin);
-  }
-}
-
-template <size_t R, size_t A>
-Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana,
-    RomajiVariants&& variants)
-    : Kana{romaji, hiragana, katakana, {}, {}, std::move(variants)} {}
-
-template <size_t R, size_t A>
-Kana::Kana(CharArray<R> romaji, CharArray<A> hiragana, CharArray<A> katakana,
-    const char* hepburn, const char* kunrei, RomajiVariants&& variants)
-    : _romaji{romaji}, _hiragana{hiragana}, _katakana{katakana},
-      _hepburn{hepburn ? OptString{hepburn} : std::nullopt},
-      _kunrei{kunrei ? OptString{kunrei} : std::nullopt}, _variants{std::move(
-                                                              variants)} {
-  static_assert(R <= RomajiArrayMax);
-  // Hiragana and Katakana must be the same size (3 or 6) and also check that
-  // Rōmaji is at least 1 character for a monograph or 2 for a digraph
-  static_assert(A == OneKanaArraySize && R >= RomajiArrayMin ||
-                A == TwoKanaArraySize && R > RomajiArrayMin);
-  validate();
-}
-
-template <typename... T>
-DakutenKana::DakutenKana(Kana&& dakuten, T&&... t)
-    : Kana{std::forward<T>(t)...}, _dakuten{std::move(dakuten), *this} {}
-
-template <typename... T>
-HanDakutenKana::HanDakutenKana(Kana&& hanDakuten, T&&... t)
-    : DakutenKana{std::forward<T>(t)...}, _hanDakuten{
-                                              std::move(hanDakuten), *this} {}
-
 } // namespace kanji_tools
@@ -1,14 +1,23 @@
+#include <kt_kana/DisplaySize.h>
 #include <kt_kana/Kana.h>
 #include <kt_kana/KanaConvert.h>
 #include <kt_kana/Table.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <unistd.h>
 
 namespace kanji_tools {
 
 namespace {
 
+// minimum size of each part converted by a job in batch mode ('-j' option)
+constexpr size_t BatchPartSize{ConverterStream::DefaultChunkSize * 16};
+
 class KanaCount final {
 public:
   void add(const Kana& i) {
@@ -87,14 +96,14 @@ void printChartFooter(std::ostream& out, bool markdown, size_t romajiVariants,
                  << "), N types aren't included in 'All Kana'\n";
 }
 
-[[nodiscard]] String getHepburn(const Kana& i, const String& romaji) {
-  auto& hepburn{i.getRomaji(ConvertFlags::Hepburn)};
+[[nodiscard]] String getHepburn(const Kana& i, StringView romaji) {
+  const String hepburn{i.getRomaji(ConvertFlags::Hepburn)};
   return romaji == hepburn ? emptyString()
                            : addBrackets(hepburn, BracketType::Round);
 }
 
-[[nodiscard]] String getKunrei(const Kana& i, const String& romaji) {
-  auto& kunrei{i.getRomaji(ConvertFlags::Kunrei)};
+[[nodiscard]] String getKunrei(const Kana& i, StringView romaji) {
+  const String kunrei{i.getRomaji(ConvertFlags::Kunrei)};
   return romaji == kunrei    ? emptyString()
          : i.kunreiVariant() ? kunrei
                              : addBrackets(kunrei, BracketType::Round);
@@ -104,10 +113,12 @@ void printChartFooter(std::ostream& out, bool markdown, size_t romajiVariants,
 
 void KanaConvert::error(const String& msg) { throw DomainError(msg); }
 
-KanaConvert::KanaConvert(const Args& args, std::ostream& out, std::istream* in)
-    : _out(out), _in(in), _choice{out, in} {
+KanaConvert::KanaConvert(
+    const Args& args, std::ostream& out, std::istream* in, std::ostream& err)
+    : _out(out), _in(in), _err(err), _choice{out, in} {
   auto printKana{false}, printMarkdown{false};
   List strings;
+  std::vector<std::filesystem::path> files;
   for (Args::Size i{1}; i < args.size(); ++i)
     if (String arg{args[i]}; arg == "--")
       while (++i < args.size()) strings.emplace_back(args[i]);
@@ -118,15 +129,36 @@ KanaConvert::KanaConvert(const Args& args, std::ostream& out, std::istream* in)
       if (++i >= args.size()) error("-f must be followed by a flag value");
       if (arg = args[i]; arg.size() != 1 || !flagArgs(arg[0]))
         error("illegal option for -f: " + arg);
+    } else if (arg == "-F") {
+      if (++i >= args.size()) error("-F must be followed by a file name");
+      files.emplace_back(args[i]);
+    } else if (arg == "-j") {
+      if (++i >= args.size()) error("-j must be followed by number of jobs");
+      _jobs = getJobs(args[i]);
     } else if (!processArg(arg, printKana, printMarkdown))
       strings.emplace_back(arg);
 
-  if (!strings.empty()) {
-    if (_interactive || printKana || printMarkdown)
-      error("'string' args can't be combined with '-i', '-m' or '-p'");
+  if (_jobs && files.empty()) error("'-j' requires one or more '-F' files");
+  if (_allForms && (!files.empty() || _live || printKana || printMarkdown))
+    error("'-a' can't be combined with '-F', '-l', '-m' or '-p'");
+  if (!files.empty()) {
+    if (!strings.empty() || _interactive || _live || printKana ||
+        printMarkdown)
+      error("'-F' can't be combined with 'string' args, '-i', '-l', '-m' or "
+            "'-p'");
+    for (auto& i : files)
+      if (_jobs)
+        convertBatch(i);
+      else
+        convertFile(i);
+  } else if (!strings.empty()) {
+    if (_interactive || _live || printKana || printMarkdown)
+      error("'string' args can't be combined with '-i', '-l', '-m' or '-p'");
     start(strings);
   } else if (printKana || printMarkdown)
     printKanaChart(printMarkdown);
+  else if (_live)
+    liveInput();
   else {
     // when testing ('_in' is defined) or reading from a tty then require
     // '-i' if no string args are provided. If stdin is not a tty (like a
@@ -141,12 +173,17 @@ bool KanaConvert::processArg(
     const String& arg, bool& printKana, bool& printMarkdown) {
   const auto setBool{[this, &printKana, &printMarkdown](bool& b) {
     // NOLINTNEXTLINE: NonNullParamChecker
-    if (_interactive || _suppressNewLine || printKana || printMarkdown)
-      error("can only specify one of -i, -m, -n, or -p");
+    if (_interactive || _live || _suppressNewLine || printKana ||
+        printMarkdown)
+      error("can only specify one of -i, -l, -m, -n, or -p");
     b = true;
   }};
-  if (arg == "-i")
+  if (arg == "-a")
+    _allForms = true;
+  else if (arg == "-i")
     setBool(_interactive);
+  else if (arg == "-l")
+    setBool(_live);
   else if (arg == "-m")
     setBool(printMarkdown);
   else if (arg == "-n")
@@ -189,11 +226,24 @@ bool KanaConvert::flagArgs(char arg) {
 
 void KanaConvert::usage(bool showAllOptions) const {
   if (showAllOptions) {
-    _out << R"(usage: kanaConvert -i
-       kanaConvert [-n] string ...
+    _out << R"(usage: kanaConvert [-a] -i
+       kanaConvert -l
+       kanaConvert [-a] [-n] string ...
+       kanaConvert [-j jobs] -F file ...
        kanaConvert -m|-p|-?
+  -a: print all forms (Hiragana, Katakana and Rōmaji separated by tabs) for
+     each string or line of input instead of converting to one target
   -i: interactive mode
+  -l: live interactive mode, Rōmaji is converted to Kana as keys are typed
+     (Backspace deletes, Enter starts a new line and Ctrl-D quits)
   -n: suppress newline on output (for non-interactive mode)
+  -F file: convert contents of 'file' (streamed so it can be any size), can be
+     used multiple times to convert files one after another
+  -j jobs: batch mode, split '-F' files at safe boundaries and convert up to
+     'jobs' parts in parallel (output order is preserved), throughput for each
+     file is reported to stderr. Boundaries are newlines, spaces and Ascii
+     punctuation so long stretches without any (like a very long line of
+     Kana) are converted on one thread
   -m: print Kana chart in 'Markdown' format and exit
   -p: print Kana chart aligned for terminal output and exit
   -?: prints this usage message
@@ -222,6 +272,11 @@ related flags can also be specified:
 void KanaConvert::start(const List& strings) {
   if (strings.empty())
     getInput();
+  else if (_allForms)
+    for (auto& i : strings) {
+      convert(i);
+      _out << '\n';
+    }
   else {
     for (auto space{false}; auto& i : strings) {
       if (space)
@@ -244,6 +299,41 @@ void KanaConvert::getInput() {
   }
 }
 
+void KanaConvert::liveInput() {
+  static constexpr char Backspace{'\b'}, Delete{'\x7f'}, CtrlD{'\x04'};
+  if (_converter.target() == CharType::Romaji)
+    error("'-l' requires Hiragana or Katakana target");
+  if (_source && *_source != CharType::Romaji)
+    error("'-l' only supports Rōmaji source");
+  _out << ">>> live mode: target=" << toString(_converter.target())
+       << ", flags=" << _converter.flagString()
+       << "\n>>> type Rōmaji (Backspace=delete, Enter=new line, "
+          "Ctrl-D=quit):\n";
+  RomajiInput input{_converter.target(), _converter.flags()};
+  const auto show{[this](RomajiInput::Change c) {
+    // move back over erased text, blank it out and then move back again
+    if (const auto size{displaySize(String{c.erased})}; size)
+      _out << String(size, Backspace) << String(size, ' ')
+           << String(size, Backspace);
+    _out << c.inserted << std::flush;
+  }};
+  const auto next{[this](char& c) {
+    return _in ? static_cast<bool>(_in->get(c))
+               : (c = Choice::getOneChar()) != 0; // XCOV_EXCL_LINE
+  }};
+  for (char c{}; next(c) && c != CtrlD;)
+    if (c == '\n' || c == '\r') {
+      show(input.flush());
+      _out << '\n';
+      input.clear();
+    } else if (c == Backspace || c == Delete)
+      show(input.backspace());
+    else if (toUChar(c) >= ' ') // ignore other control characters
+      show(input.push(c));
+  show(input.flush());
+  if (!input.text().empty()) _out << '\n';
+}
+
 void KanaConvert::printOptions() const {
   _out << ">>> current options: source="
        << (_source ? toString(*_source) : "any")
@@ -272,7 +362,104 @@ bool KanaConvert::processLine(const String& line) {
 }
 
 void KanaConvert::convert(const String& s) {
-  _out << (_source ? _converter.convert(*_source, s) : _converter.convert(s));
+  if (!_allForms) {
+    _out << (_source ? _converter.convert(*_source, s) : _converter.convert(s));
+    return;
+  }
+  KanaForms forms;
+  if (_source)
+    _converter.convertForms(*_source, s, forms);
+  else
+    // without a source each form is converted from all the other types
+    for (const auto target : CharTypes)
+      convertKana(s, target, _converter.flags(), forms[target]);
+  _out << forms.hiragana << '\t' << forms.katakana << '\t' << forms.romaji;
+}
+
+KanaConvert::Jobs KanaConvert::getJobs(const String& arg) {
+  if (arg.empty() || !std::all_of(arg.begin(), arg.end(),
+                         [](char c) { return c >= '0' && c <= '9'; }))
+    error("invalid value for '-j': " + arg);
+  if (const auto i{std::stoul(arg)};
+      i && i <= std::numeric_limits<Jobs>::max())
+    return static_cast<Jobs>(i);
+  error("value for '-j' must be from 1 to " +
+        std::to_string(std::numeric_limits<Jobs>::max()));
+  return 0; // XCOV_EXCL_LINE: 'error' always throws
+}
+
+ConverterStream KanaConvert::stream() const {
+  return _source ? ConverterStream{_converter, *_source}
+                 : ConverterStream{_converter};
+}
+
+void KanaConvert::convertFile(const std::filesystem::path& file) {
+  std::ifstream in{file, std::ios::binary};
+  if (!in) error("can't open file: " + file.string());
+  stream().convert(in, _out);
+}
+
+void KanaConvert::convertBatch(const std::filesystem::path& file) {
+  std::ifstream in{file, std::ios::binary};
+  if (!in) error("can't open file: " + file.string());
+  const auto start{std::chrono::steady_clock::now()};
+  const auto blockSize{BatchPartSize * _jobs};
+  size_t total{};
+  String input;
+  // input is converted by 'sequential' (without waiting for the rest of the
+  // part) when a whole block has no split points, e.g., a long line of Kana
+  // with no Ascii punctuation, so 'input' doesn't keep growing. This continues
+  // until a split point is found and then parallel conversion resumes.
+  auto sequential{stream()};
+  for (auto eof{false}, streaming{false}; !eof || !input.empty();) {
+    if (!eof) {
+      const auto size{input.size()};
+      input.resize(size + blockSize);
+      in.read(input.data() + size, static_cast<std::streamsize>(blockSize));
+      input.resize(size + static_cast<size_t>(in.gcount()));
+      total += static_cast<size_t>(in.gcount());
+      eof = in.eof();
+    }
+    // anything after the last split point is carried over to the next loop
+    // (once the whole file has been read it becomes the final part)
+    auto points{ConverterStream::splitPoints(input, BatchPartSize, eof)};
+    if (eof) points.emplace_back(input.size());
+    if (streaming || (points.empty() && input.size() >= blockSize)) {
+      String out;
+      if (streaming = points.empty(); streaming) {
+        sequential.feed(input, out);
+        input.clear();
+      } else {
+        sequential.finish(StringView{input}.substr(0, points[0]), out);
+        input.erase(0, points[0]);
+      }
+      _out << out;
+      continue;
+    }
+    if (points.size() > _jobs) points.resize(_jobs);
+    std::vector<std::future<String>> parts;
+    for (size_t prev{}; const auto i : points) {
+      parts.emplace_back(std::async(std::launch::async,
+          [this, part = StringView{input}.substr(prev, i - prev)] {
+            String out;
+            stream().finish(part, out);
+            return out;
+          }));
+      prev = i;
+    }
+    for (auto& i : parts) _out << i.get();
+    if (!points.empty()) input.erase(0, points.back());
+  }
+  const std::chrono::duration<double> secs{
+      std::chrono::steady_clock::now() - start};
+  static constexpr double BytesPerMB{1024 * 1024};
+  _err << file.string() << ": " << total << " bytes, " << std::fixed
+       << std::setprecision(3) << secs.count() << " secs ("
+       << std::setprecision(1)
+       << (secs.count() > 0
+                  ? static_cast<double>(total) / BytesPerMB / secs.count()
+                  : 0)
+       << " MB/s, jobs=" << _jobs << ")\n";
 }
 
 void KanaConvert::setFlag(ConvertFlags value) {
@@ -296,9 +483,7 @@ void KanaConvert::printKanaChart(bool markdown) const {
     romajiVariants += i.romajiVariants().size();
     (i.isMonograph() ? monographs : digraphs).add(i);
     const String type{i.isDakuten() ? "D" : i.isHanDakuten() ? "H" : "P"};
-    auto& romaji{i.romaji()};
-    auto& h{i.hiragana()};
-    auto& k{i.katakana()};
+    const String romaji{i.romaji()}, h{i.hiragana()}, k{i.katakana()};
     const auto hepburn{getHepburn(i, romaji)}, kunrei{getKunrei(i, romaji)};
     String vars;
     for (auto& j : i.romajiVariants()) {
@@ -313,12 +498,11 @@ void KanaConvert::printKanaChart(bool markdown) const {
         groups.contains(romaji));
   }
   // special handling for middle dot, prolong mark and repeat marks
-  const String slash{"/"}, middleDot{"・"};
+  const String slash{"/"}, middleDot{"・"}, prolong{Kana::ProlongMark};
   table.add({"N", slash, {}, middleDot, {}, toUnicode(middleDot)}, true);
-  table.add({"N", {}, {}, Kana::ProlongMark, {}, toUnicode(Kana::ProlongMark)});
+  table.add({"N", {}, {}, prolong, {}, toUnicode(prolong)});
   for (auto& i : std::array{&Kana::RepeatPlain, &Kana::RepeatAccented}) {
-    auto& h{i->hiragana()};
-    auto& k{i->katakana()};
+    const String h{i->hiragana()}, k{i->katakana()};
     table.add({"N", {}, h, k, toUnicode(h), toUnicode(k)});
   }
   markdown ? table.printMarkdown(_out) : table.print(_out);
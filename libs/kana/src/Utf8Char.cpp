@@ -34,23 +34,18 @@ bool Utf8Char::isCombiningMark(const String& s) {
 }
 
 size_t Utf8Char::size(const char* s, bool onlyMB) {
-  size_t result{};
-  // a 'reinterpret_cast' at the beginning saves a bunch of static_casts when
-  // checking if the next 3 bytes represent a 'variation selector'
-  if (auto i{reinterpret_cast<const uint8_t*>(s)}; i) {
-    while (*i)
-      if (isCombiningMark(i) || isVariationSelector(i))
-        i += VarSelectorSize;
-      else if (onlyMB)
-        // use '11 00 00 00' to get first two bits and increment if equal to
-        // '11 00 00 00' - this only counts start bytes of 'multi-byte' UTF-8
-        result += (*i++ & TwoBits) == TwoBits;
-      else
-        // use '11 00 00 00' to get first two bits and increment if not equal to
-        // '10 00 00 00' - this will count both single byte UTF-8 as well as
-        // start bytes of 'multi-byte' UTF-8 (and skip continuation bytes)
-        result += (*i++ & TwoBits) != Bit1;
-  }
+  if (!s) return 0;
+  const StringView v{s};
+  auto result{countUtf8Starts(v, onlyMB)};
+  // variation selectors and combining marks aren't counted (they modify the
+  // previous character) so find their first two bytes and subtract them
+  static constexpr StringView VarSelectorStart{"\xef\xb8"},
+      CombiningMarkStart{"\xe3\x82"};
+  for (auto i{findEitherPair(v, VarSelectorStart, CombiningMarkStart)};
+       i < v.size();
+       i += 1 + findEitherPair(
+                    v.substr(i + 1), VarSelectorStart, CombiningMarkStart))
+    if (isCombiningMark(s + i) || isVariationSelector(s + i)) --result;
   return result;
 }
 
@@ -84,65 +79,20 @@ String Utf8Char::getFirst(const String& s) {
 
 Utf8Char::Utf8Char(const String& data) : _data{data} {}
 
-void Utf8Char::reset() {
-  _curLocation = _data.c_str();
-  _errors = _variants = _combiningMarks = 0;
-}
+void Utf8Char::reset() { _view.reset(); }
 
 bool Utf8Char::next(String& result, bool onlyMB) {
-  while (*_curLocation) {
-    switch (validateMBUtf8(_curLocation)) {
-    case MBUtf8Result::NotMultiByte:
-      if (!onlyMB) {
-        result = *_curLocation++;
-        return true;
-      }
-      ++_curLocation; // skip regular ascii when onlyMB is true
-      break;
-    case MBUtf8Result::Valid:
-      if (String curChar; validResult(curChar, _curLocation)) {
-        if (String nexChar; peekVariant(nexChar, _curLocation)) {
-          _curLocation += VarSelectorSize;
-          ++_variants;
-          result = curChar + nexChar;
-        } else
-          result = processOne(*this, curChar, nexChar);
-        return true;
-      }
-      ++_errors; // can't start with a variation selector or a combining mark
-      break;
-    case MBUtf8Result::NotValid:
-      // _loc doesn't start a valid utf8 sequence so try next byte
-      ++_curLocation;
-      ++_errors;
-    }
-  }
-  return false;
+  StringView r;
+  if (!_view.next(r, onlyMB)) return false;
+  result = r;
+  return true;
 }
 
 bool Utf8Char::peek(String& result, bool onlyMB) const {
-  for (auto location{_curLocation}; *location;) {
-    switch (validateMBUtf8(location)) {
-    case MBUtf8Result::NotMultiByte:
-      if (!onlyMB) {
-        result = *location;
-        return true;
-      }
-      ++location;
-      break;
-    case MBUtf8Result::Valid:
-      if (String curChar; validResult(curChar, location)) {
-        if (String nextChar; peekVariant(nextChar, location))
-          result = curChar + nextChar;
-        else
-          result = processOne(*this, curChar, nextChar);
-        return true;
-      }
-      break;
-    case MBUtf8Result::NotValid: ++location;
-    }
-  }
-  return false;
+  StringView r;
+  if (!_view.peek(r, onlyMB)) return false;
+  result = r;
+  return true;
 }
 
 size_t Utf8Char::size(bool onlyMB) const { return size(_data, onlyMB); }
@@ -155,44 +105,87 @@ bool Utf8Char::isValid(bool sizeOne) const {
   return valid(sizeOne) == MBUtf8Result::Valid;
 }
 
-String Utf8Char::getMBUtf8(const char*& loc) {
-  const auto firstOfGroup{toUChar(*loc)};
-  String result{*loc++};
-  for (uint8_t x{Bit2}; x && firstOfGroup & x; x >>= 1U) result += *loc++;
-  return result;
+// Utf8CharView
+
+namespace {
+
+/// return true if `s` is a variation selector (`s` can be an empty view)
+[[nodiscard]] bool isVariationSelector(StringView s) {
+  return s.size() == VarSelectorSize && Utf8Char::isVariationSelector(s.data());
 }
 
-bool Utf8Char::validResult(String& result, const char*& loc) {
-  return !isVariationSelector(result = getMBUtf8(loc)) &&
-         !isCombiningMark(result);
+/// return true if `s` is a combining mark (`s` can be an empty view)
+[[nodiscard]] bool isCombiningMark(StringView s) {
+  return s.size() == VarSelectorSize && Utf8Char::isCombiningMark(s.data());
 }
 
-bool Utf8Char::peekVariant(String& result, const char* loc) {
-  return isValidMBUtf8(loc) && isVariationSelector(result = getMBUtf8(loc));
+} // namespace
+
+Utf8CharView::Utf8CharView(StringView data) noexcept : _data{data} {}
+
+void Utf8CharView::reset() noexcept {
+  _curLocation = _data.data();
+  _errors = _variants = _combiningMarks = 0;
 }
 
-template <typename T>
-String Utf8Char::processOne(T& t, const String& cur, const String& next) {
-  return next == CombiningVoiced ? t.combiningMark(cur, Kana::findDakuten(cur))
-         : next == CombiningSemiVoiced
-             ? t.combiningMark(cur, Kana::findHanDakuten(cur))
-             : cur;
+bool Utf8CharView::next(StringView& result, bool onlyMB) {
+  return next(*this, _curLocation, result, onlyMB);
+}
+
+bool Utf8CharView::peek(StringView& result, bool onlyMB) const {
+  auto location{_curLocation};
+  return next(*this, location, result, onlyMB);
 }
 
-// NOLINTNEXTLINE: keep this non-static (for now) to allow overloading by const
-String Utf8Char::combiningMark(
-    const String& base, const OptString& accented) const {
-  return accented.value_or(base);
+template <typename T>
+bool Utf8CharView::next(
+    T& t, const char*& loc, StringView& result, bool onlyMB) {
+  static constexpr auto Count{!std::is_const_v<T>};
+  for (const auto end{t.end()}; loc != end;)
+    if (isSingleByteChar(*loc)) {
+      if (!onlyMB) {
+        result = {loc++, 1};
+        return true;
+      }
+      loc += asciiPrefixSize({loc, end}); // skip Ascii when onlyMB is true
+    } else if (const auto size{getMBUtf8Size({loc, end})}; !size) {
+      // loc doesn't start a valid utf8 sequence so try next byte
+      ++loc;
+      if constexpr (Count) ++t._errors;
+    } else {
+      const StringView cur{loc, size};
+      loc += size;
+      // can't start with a variation selector or a combining mark
+      if (isVariationSelector(cur) || isCombiningMark(cur)) {
+        if constexpr (Count) ++t._errors;
+        continue;
+      }
+      if (const StringView nextChar{loc, getMBUtf8Size({loc, end})};
+          isVariationSelector(nextChar)) {
+        loc += VarSelectorSize;
+        if constexpr (Count) ++t._variants;
+        result = {cur.data(), size + VarSelectorSize};
+      } else
+        result = processOne(t, loc, cur, nextChar);
+      return true;
+    }
+  return false;
 }
 
-String Utf8Char::combiningMark(const String& base, const OptString& accented) {
-  _curLocation += VarSelectorSize;
-  if (accented) {
-    ++_combiningMarks;
-    return *accented;
+template <typename T>
+StringView Utf8CharView::processOne(
+    T& t, const char*& loc, StringView cur, StringView next) {
+  if (!isCombiningMark(next)) return cur;
+  loc += VarSelectorSize;
+  const auto c{*Utf8View{cur}.begin()};
+  if (const auto r{next == CombiningVoiced ? Kana::composeDakuten(c)
+                                           : Kana::composeHanDakuten(c)};
+      !r.empty()) {
+    if constexpr (!std::is_const_v<T>) ++t._combiningMarks;
+    return r;
   }
-  ++_errors;
-  return base;
+  if constexpr (!std::is_const_v<T>) ++t._errors;
+  return cur;
 }
 
 } // namespace kanji_tools
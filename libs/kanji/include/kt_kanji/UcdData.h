@@ -1,6 +1,5 @@
 #pragma once
 
-#include <kt_kana/Converter.h>
 #include <kt_kanji/Ucd.h>
 
 #include <filesystem>
@@ -24,6 +23,7 @@ public:
   /// return a (wide) comma separated string starting with 'onReading' converted
   /// to Katakana followed by 'kunReading' converted to Hiragana (spaces within
   /// the readings are also converted to wide commas)
+  /// \note this function is safe to call concurrently from multiple threads
   [[nodiscard]] String getReadingsAsKana(UcdPtr) const;
 
   /// return pointer to a Ucd instance if `name` is found, otherwise nullptr
@@ -57,9 +57,6 @@ private:
   /// \li otherwise it will be put in '_linkedOther' @{
   std::map<String, String> _linkedJinmei;
   std::map<String, std::vector<String>> _linkedOther; ///@}
-
-  /// used by getReadingsAsKana() to convert Rōmaji readings loaded from UCD
-  mutable Converter _converter;
 };
 
 /// \end_group
@@ -2,6 +2,7 @@
 #include <kt_utils/Utf8.h>
 
 #include <algorithm>
+#include <cassert>
 #include <sstream>
 
 namespace kanji_tools {
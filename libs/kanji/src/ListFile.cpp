@@ -65,6 +65,10 @@ void ListFile::load(const Path& file, FileType fileType,
   std::ifstream f{file};
   ListFile::StringList dups;
   for (String line; std::getline(f, line); ++lineNum) {
+    // check the whole line first to report the position of bad UTF-8
+    if (const auto v{validateUtf8(std::span<const char>{line})};
+        v.result != Utf8Result::Valid)
+      error("invalid UTF-8 at byte " + std::to_string(v.offset));
     std::stringstream ss{line};
     for (String token; std::getline(ss, token, ' ');)
       if (fileType == FileType::OnePerLine && token != line)
@@ -85,7 +89,10 @@ void ListFile::load(const Path& file, FileType fileType,
 template <typename T>
 bool ListFile::validate(
     const T& error, StringSet* uniqueNames, const String& token) {
-  if (!isValidMBUtf8(token, true))
+  // lines are already validated by 'load' so only check that 'token' is one
+  // multi-byte value (instead of validating it again)
+  if (token.empty() || isSingleByteChar(token[0]) ||
+      countUtf8Starts(token, false) != 1)
     error("invalid multi-byte token '" + token + "'");
   // check uniqueness within file
   if (_map.find(token) != _map.end()) error("got duplicate token '" + token);
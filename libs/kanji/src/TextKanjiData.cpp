@@ -3,6 +3,8 @@
 #include <kt_kanji/TextKanjiData.h>
 #include <kt_utils/Utf8.h>
 
+#include <cassert>
+#include <fstream>
 #include <sstream>
 
 namespace kanji_tools {
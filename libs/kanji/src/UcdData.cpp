@@ -1,3 +1,4 @@
+#include <kt_kana/Converter.h>
 #include <kt_kana/Utf8Char.h>
 #include <kt_kanji/KanjiData.h>
 #include <kt_utils/ColumnFile.h>
@@ -74,16 +75,15 @@ UcdPtr UcdData::find(const String& name) const {
 
 String UcdData::getReadingsAsKana(UcdPtr u) const {
   if (u) {
-    auto s{u->onReading()};
-    std::replace(s.begin(), s.end(), ' ', ',');
-    auto result{_converter.convert(CharType::Romaji, s, CharType::Katakana)};
-    s = u->kunReading();
-    if (!s.empty()) {
+    const auto convert{[](String s, CharType target, String& out) {
       std::replace(s.begin(), s.end(), ' ', ',');
+      convertKana(s, CharType::Romaji, target, ConvertFlags::None, out);
+    }};
+    String result;
+    convert(u->onReading(), CharType::Katakana, result);
+    if (const auto& kun{u->kunReading()}; !kun.empty())
       // if there are both 'on' and 'kun' readings then separate with a comma
-      if (!result.empty()) s = ',' + s;
-      result += _converter.convert(CharType::Romaji, s, CharType::Hiragana);
-    }
+      convert(result.empty() ? kun : ',' + kun, CharType::Hiragana, result);
     return result;
   }
   return emptyString();
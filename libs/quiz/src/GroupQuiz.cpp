@@ -2,6 +2,7 @@
 #include <kt_quiz/GroupQuiz.h>
 
 #include <algorithm>
+#include <cassert>
 #include <optional>
 #include <random>
 
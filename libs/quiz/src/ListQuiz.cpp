@@ -1,6 +1,7 @@
 #include <kt_quiz/ListQuiz.h>
 
 #include <algorithm>
+#include <cassert>
 #include <random>
 
 namespace kanji_tools {
@@ -44,10 +44,11 @@ size_t Utf8Count::add(const String& s, const OptString& tag) {
       }
     }
   }
-  Utf8Char c{n};
+  Utf8CharView c{n};
   size_t added{};
-  for (String token; c.next(token);)
-    if (allowAdd(token)) {
+  String token;
+  for (StringView v; c.next(v);)
+    if (allowAdd(token.assign(v))) {
       ++_map[token];
       ++added;
       if (tag) ++_tags[token][*tag];
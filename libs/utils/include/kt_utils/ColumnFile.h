@@ -3,7 +3,6 @@
 #include <kt_utils/String.h>
 
 #include <filesystem>
-#include <fstream>
 #include <map>
 #include <optional>
 #include <vector>
@@ -13,6 +12,11 @@ namespace kanji_tools { /// \utils_group{ColumnFile}
 
 /// class for loading data from a delimiter (defaults to tab) separated file
 /// with a header row containing the column names \utils{ColumnFile}
+///
+/// The file is memory mapped and rows and fields are split in place (using
+/// `memchr`) so reading a row doesn't copy any data. getView() returns a view
+/// into the mapping and get() copies a value into a String (reusing storage
+/// from previous rows) the first time it's called for a Column in a row.
 class ColumnFile final {
 public:
   /// represents a column in a ColumnFile \utils{ColumnFile}
@@ -46,8 +50,10 @@ public:
   /// \param p path to the text file to be read and processed
   /// \param columns list of columns in the file (can be specified in any order)
   /// \param delim column delimiter (defaults to tab)
-  /// \throw DomainError if 'p' cannot be opened (or is not a regular file) or
-  ///     if a column is duplicated or not found in the header row of the file
+  /// \throw DomainError if 'p' cannot be opened or mapped (the message has the
+  ///     system error text), is not a regular file or contains invalid UTF-8
+  ///     (the whole file is checked once) or if a column is duplicated or not
+  ///     found in the header row of the file
   ColumnFile(const Path& p, const Columns& columns, char delim = '\t');
 
   ColumnFile(const ColumnFile&) = delete;
@@ -57,16 +63,22 @@ public:
   /// \throw DomainError if the next row has too few or too many columns
   bool nextRow();
 
-  /// get the value for the given Column for the current row
+  /// get the value for the given Column for the current row (the reference is
+  /// valid until the next call to nextRow())
   /// \throw if nextRow() hasn't been called yet or if the given Column is not
   ///     part of the ColumnFile, i.e., it wasn't passed into the ctor
   const String& get(const Column&) const;
 
+  /// same as get(), but returns a view into the file without copying (the view
+  /// is valid for the lifetime of this object)
+  [[nodiscard]] StringView getView(const Column&) const;
+
   /// return true if the value for the given Column is empty
   [[nodiscard]] bool isEmpty(const Column&) const;
 
   /// get the value for the given Column and convert to `uint64_t`
-  /// \throw DomainError if conversion to result type fails of if `maxValue` is
+  /// \throw DomainError if conversion to result type fails (value must only
+  ///     contain decimal digits and fit in `uint64_t`) or if `maxValue` is
   ///     non-0 and less than the converted result
   uint64_t getU64(const Column&, uint64_t maxValue = 0) const;
 
@@ -101,10 +113,10 @@ public:
   /// \throw if value is not expected size or not valid hex
   Code getChar32(const Column&) const;
 
-  /// getChar32() overload that takes a #String instead of using the value from
-  /// the given Column (the Column name is only used if there is an error)
+  /// getChar32() overload that takes a #StringView instead of using the value
+  /// from the given Column (the Column name is only used if there is an error)
   /// \details can be helpful when parsing a cell with comma separated values
-  Code getChar32(const Column&, const String& s) const;
+  Code getChar32(const Column&, StringView s) const;
 
   /// convenience method for throwing an exception
   /// \param msg the string to use at the start of the exception 'what' value
@@ -115,7 +127,7 @@ public:
   void error(const String& msg, const Column&, const String&) const;
 
   /// return the number of columns in this file
-  [[nodiscard]] auto columns() const { return _rowValues.size(); }
+  [[nodiscard]] auto columns() const { return _rowViews.size(); }
 
   /// return current row number, `0` means no rows have been processed yet
   [[nodiscard]] auto currentRow() const { return _currentRow; }
@@ -124,30 +136,68 @@ public:
   [[nodiscard]] auto& fileName() const { return _fileName; }
 
 private:
+  /// read-only memory mapping of a whole file \utils{ColumnFile}
+  class Mapping final {
+  public:
+    Mapping() = default;
+
+    Mapping(const Mapping&) = delete; ///< deleted copy ctor
+
+    ~Mapping();
+
+    /// map `p` (an empty file results in an empty mapping)
+    /// \return `0` if successful, otherwise the `errno` value of the failure
+    [[nodiscard]] int map(const Path& p) noexcept;
+
+    [[nodiscard]] auto data() const { return _data; }
+    [[nodiscard]] auto size() const { return _size; }
+
+  private:
+    const char* _data{};
+    size_t _size{};
+  };
+
   /// used by Column class constructor
   [[nodiscard]] static size_t getColumnNumber(const String& name);
 
-  [[nodiscard]] uint64_t processU64(
-      const String&, const Column&, uint64_t) const;
+  [[nodiscard]] uint64_t processU64(StringView, const Column&, uint64_t) const;
 
   using ColNames = std::map<String, Column>;
 
-  void processHeaderRow(const String&, ColNames&);
+  /// set `line` to the next line of the file (without the newline)
+  /// \return false if there are no more lines
+  [[nodiscard]] bool nextLine(StringView& line);
+
+  /// return position in '_rowViews' for `column` (or call 'error')
+  [[nodiscard]] size_t position(const Column& column) const;
+
+  /// validate UTF-8 of the whole mapping (called once by the ctor)
+  void validateMapping();
+
+  void processHeaderRow(StringView, ColNames&);
   void verifyHeaderColumns(const ColNames&) const;
 
   [[nodiscard]] String errorMsg(const String&) const;
 
-  std::fstream _file;
+  Mapping _mapping;
   const char _delimiter;
 
   /// holds the 'last component name' of the file being processed
   const String _fileName;
 
+  /// offset in '_mapping' of the next line to be read
+  size_t _offset{};
+
   /// starts at `0` and is incremented each time 'nextRow' is called
   size_t _currentRow{};
 
-  /// updated each time a new row is processed by 'nextRow'
-  std::vector<String> _rowValues;
+  /// views into '_mapping' for each field, updated by 'nextRow'
+  std::vector<StringView> _rowViews;
+
+  /// copies of fields returned by get() and the row each one was copied for
+  /// (only fields that are requested are copied) @{
+  mutable std::vector<String> _rowValues;
+  mutable std::vector<size_t> _valueRows; ///@}
 
   /// maps a column 'number' to the position in _rowValues (starting at 0).
   /// \details This collection is populated by the ctor based on the order that
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <kt_utils/Bitmask.h>
+#include <kt_utils/EnumMap.h>
 #include <kt_utils/Utf8.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <iostream>
@@ -252,49 +255,254 @@ template <size_t N, typename... Ts>
   return inRange(c, t) || inRange(c, args...);
 }
 
+/// categories of Code values based on the block arrays defined above (a Code
+/// can have more than one category, e.g., U+3099 is in the Hiragana block and
+/// is also 'NonSpacing') \details supports bitwise operators so categories can
+/// be combined, e.g., `CommonKanji | RareKanji`
+enum class UnicodeCategory : uint8_t {
+  None,             ///< not in any of the block arrays (Ascii for example)
+  Hiragana,         ///< #HiraganaBlocks
+  Katakana,         ///< #KatakanaBlocks
+  CommonKanji = 4,  ///< #CommonKanjiBlocks
+  RareKanji = 8,    ///< #RareKanjiBlocks
+  Punctuation = 16, ///< #PunctuationBlocks
+  Symbol = 32,      ///< #SymbolBlocks
+  Letter = 64,      ///< #LetterBlocks
+  NonSpacing = 128  ///< #NonSpacingBlocks plus Kana combining marks
+};
+/// enable bitwise operators for #UnicodeCategory
+template <> inline constexpr auto is_bitmask<UnicodeCategory>{true};
+
+/// combined categories used by 'is' functions like isKana() and isKanji() @{
+inline constexpr auto KanaCategories{
+    UnicodeCategory::Hiragana | UnicodeCategory::Katakana},
+    KanjiCategories{UnicodeCategory::CommonKanji | UnicodeCategory::RareKanji},
+    RecognizedCategories{KanaCategories | KanjiCategories |
+                         UnicodeCategory::Punctuation |
+                         UnicodeCategory::Symbol | UnicodeCategory::Letter};
+///@}
+
+/// number of bits of a Code used to index into a 'page' of #UnicodeCategories
+inline constexpr Code CategoryPageBits{8};
+
+/// number of Code values in a page of #UnicodeCategories
+inline constexpr Code CategoryPageSize{1U << CategoryPageBits};
+
+/// number of pages covered by #UnicodeCategories, all Code values in pages past
+/// the end (including the rest of the Unicode range) are UnicodeCategory::None
+inline constexpr Code CategoryPages{
+    RareKanjiBlocks.back().end() / CategoryPageSize + 1};
+
+/// call `f` with start, end and #UnicodeCategory for all categorized ranges
+consteval void forEachCategoryRange(auto f) {
+  const auto add{[&f](auto& blocks, UnicodeCategory c) {
+    for (auto& i : blocks) f(i.start(), i.end(), c);
+  }};
+  add(HiraganaBlocks, UnicodeCategory::Hiragana);
+  add(KatakanaBlocks, UnicodeCategory::Katakana);
+  add(CommonKanjiBlocks, UnicodeCategory::CommonKanji);
+  add(RareKanjiBlocks, UnicodeCategory::RareKanji);
+  add(PunctuationBlocks, UnicodeCategory::Punctuation);
+  add(SymbolBlocks, UnicodeCategory::Symbol);
+  add(LetterBlocks, UnicodeCategory::Letter);
+  add(NonSpacingBlocks, UnicodeCategory::NonSpacing);
+  static_assert(CombiningVoicedChar + 1 == CombiningSemiVoicedChar);
+  f(CombiningVoicedChar, CombiningSemiVoicedChar, UnicodeCategory::NonSpacing);
+}
+
+/// summary of each page of #UnicodeCategories used when building the table
+struct CategoryPageSummary final {
+  /// categories for pages fully covered by ranges (only valid if not 'mixed')
+  std::array<UnicodeCategory, CategoryPages> category{};
+  /// true if a range starts or ends part way through a page
+  std::array<bool, CategoryPages> mixed{};
+};
+
+/// return a CategoryPageSummary for all pages
+[[nodiscard]] consteval auto summarizeCategoryPages() {
+  CategoryPageSummary result;
+  forEachCategoryRange([&result](Code start, Code end, UnicodeCategory c) {
+    if (start % CategoryPageSize) result.mixed[start / CategoryPageSize] = true;
+    if (++end % CategoryPageSize) result.mixed[end / CategoryPageSize] = true;
+    for (auto i{(start + CategoryPageSize - 1) / CategoryPageSize};
+         i < end / CategoryPageSize; ++i)
+      result.category[i] |= c;
+  });
+  return result;
+}
+
+/// return the number of distinct pages required for #UnicodeCategories, i.e.,
+/// one per 'mixed' page plus one per distinct category of the other pages
+[[nodiscard]] consteval size_t countCategoryPages() {
+  const auto summary{summarizeCategoryPages()};
+  std::array<bool, 1U << 8 * sizeof(UnicodeCategory)> found{};
+  size_t result{};
+  for (size_t i{}; i < CategoryPages; ++i)
+    if (summary.mixed[i])
+      ++result;
+    else if (auto& f{found[to_underlying(summary.category[i])]}; !f) {
+      f = true;
+      ++result;
+    }
+  return result;
+}
+
+/// two-stage lookup table for getting the #UnicodeCategory of a Code in O(1)
+/// \details The first stage maps the 'page' of a Code (its upper bits) to one
+/// of `N` pages in the second stage. Pages that are entirely one category (like
+/// most of the Kanji pages) are shared so the whole table is less than 10K.
+/// \tparam N number of distinct pages (see countCategoryPages())
+template <size_t N> class UnicodeCategoryTable final {
+public:
+  /// build the table from the block arrays (see forEachCategoryRange())
+  consteval UnicodeCategoryTable() {
+    static_assert(N <= 1U << 8 * sizeof(uint8_t));
+    const auto summary{summarizeCategoryPages()};
+    std::array<uint8_t, 1U << 8 * sizeof(UnicodeCategory)> uniform{};
+    uint8_t pages{};
+    for (size_t i{}; i < CategoryPages; ++i)
+      if (summary.mixed[i])
+        _index[i] = pages++;
+      else if (auto& u{uniform[to_underlying(summary.category[i])]}; u)
+        _index[i] = static_cast<uint8_t>(u - 1);
+      else {
+        _pages[pages].fill(summary.category[i]);
+        _index[i] = pages++;
+        u = pages; // store one more than index to distinguish from 'not found'
+      }
+    // set the categories for all Code values in 'mixed' pages
+    forEachCategoryRange([&](Code start, Code end, UnicodeCategory c) {
+      for (auto i{start / CategoryPageSize}; i <= end / CategoryPageSize; ++i)
+        if (summary.mixed[i])
+          for (auto j{std::max<Code>(start, i * CategoryPageSize)};
+               j <= std::min<Code>(end, (i + 1) * CategoryPageSize - 1); ++j)
+            _pages[_index[i]][j % CategoryPageSize] |= c;
+    });
+  }
+
+  /// return the #UnicodeCategory bitmask for `c`
+  [[nodiscard]] constexpr auto operator()(Code c) const noexcept {
+    const auto page{c >> CategoryPageBits};
+    return page < CategoryPages
+               ? _pages[_index[page]][c & (CategoryPageSize - 1)]
+               : UnicodeCategory::None;
+  }
+
+private:
+  std::array<uint8_t, CategoryPages> _index{};
+  std::array<std::array<UnicodeCategory, CategoryPageSize>, N> _pages{};
+};
+
+/// table used by getCategory() (built at compile time)
+inline constexpr UnicodeCategoryTable<countCategoryPages()> UnicodeCategories;
+
+/// return the #UnicodeCategory bitmask for `c` (a single table lookup instead
+/// of calling inRange() on multiple block arrays)
+[[nodiscard]] constexpr auto getCategory(Code c) noexcept {
+  return UnicodeCategories(c);
+}
+
+/// return true if `c` has any of the categories in `categories`
+[[nodiscard]] constexpr auto inCategory(
+    Code c, UnicodeCategory categories) noexcept {
+  return hasValue(getCategory(c) & categories);
+}
+
+/// ideographic (wide) space: U+3000
+inline constexpr Code WideSpace{U'\x3000'};
+
 /// return true if `c` is a non-spacing Code
 [[nodiscard]] constexpr auto isNonSpacing(Code c) noexcept {
-  return inRange(c, NonSpacingBlocks) || c == CombiningVoicedChar ||
-         c == CombiningSemiVoicedChar;
+  return inCategory(c, UnicodeCategory::NonSpacing);
 }
 
-/// return true if the first 'MB character' is in the given blocks. Empty string
-/// will return false and a string longer than one 'MB character' also returns
-/// false unless `sizeOne` is false.
-template <typename... T>
-[[nodiscard]] auto inWCharRange(const String& s, bool sizeOne, T&... t) {
+/// return true if the first 'MB character' is in the given categories. Empty
+/// string will return false and a string longer than one 'MB character' also
+/// returns false unless `sizeOne` is false.
+[[nodiscard]] inline auto inWCharRange(
+    StringView s, bool sizeOne, UnicodeCategory categories) {
   // a string with only one byte can't hold an MB char so don't need to check it
   if (s.size() > 1) {
-    if (!sizeOne) {
-      // only check the first 'wide' character when 'sizeOne' is false
-      const auto w{fromUtf8(s, 1)};
-      return w.size() == 1 && inRange(w[0], t...);
-    }
-    if (s.size() <= MaxMBSize * 2U) {
-      // when 'sizeOne' is true then need to convert (up to) three characters so
-      // that the second position can be tested for 'non-spacing'
-      const auto w{fromUtf8(s, 3)};
-      return (w.size() == 1 || w.size() == 2 && isNonSpacing(w[1])) &&
-             inRange(w[0], t...);
-    }
+    const Utf8View v{s};
+    auto i{v.begin()};
+    // only check the first 'wide' character when 'sizeOne' is false
+    if (!inCategory(*i, categories)) return false;
+    if (!sizeOne) return true;
+    // when 'sizeOne' is true then the second position (if there is one) must be
+    // 'non-spacing' and there can't be a third position
+    return s.size() <= MaxMBSize * 2U &&
+           (++i == v.end() || isNonSpacing(*i) && ++i == v.end());
   }
   return false;
 }
 
-/// true if `s` is empty or every char in `s` is in the given blocks
-template <typename... T>
-[[nodiscard]] auto inWCharRange(const String& s, T&... t) {
-  // an 'inRange' character can be followed by a 'variation selector'
-  for (auto allowNonSpacing{false}; const auto i : fromUtf8(s))
+/// true if `r` (a range of Code values) is empty or every value is in the given
+/// categories (a value in the categories can be followed by a 'non-spacing'
+/// value like a 'variation selector' or a Kana combining mark)
+template <typename R>
+[[nodiscard]] constexpr auto allInCategory(
+    const R& r, UnicodeCategory categories) noexcept {
+  for (auto allowNonSpacing{false}; const Code i : r)
     if (allowNonSpacing && isNonSpacing(i))
       allowNonSpacing = false;
-    else if (inRange(i, t...))
+    else if (inCategory(i, categories))
       allowNonSpacing = true;
     else
       return false;
   return true;
 }
 
+/// true if `s` is empty or every char in `s` is in the given categories
+[[nodiscard]] inline auto inWCharRange(
+    StringView s, UnicodeCategory categories) {
+  return allInCategory(Utf8View{s}, categories);
+}
+
+// 'is' functions for Code values
+
+/// return true if `c` is of the expected type
+[[nodiscard]] constexpr auto isKana(Code c) noexcept {
+  return inCategory(c, KanaCategories);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isHiragana(Code c) noexcept {
+  return inCategory(c, UnicodeCategory::Hiragana);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isKatakana(Code c) noexcept {
+  return inCategory(c, UnicodeCategory::Katakana);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isKanji(Code c) noexcept {
+  return inCategory(c, KanjiCategories);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isCommonKanji(Code c) noexcept {
+  return inCategory(c, UnicodeCategory::CommonKanji);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isRareKanji(Code c) noexcept {
+  return inCategory(c, UnicodeCategory::RareKanji);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isMBSymbol(Code c) noexcept {
+  return inCategory(c, UnicodeCategory::Symbol);
+}
+/// \doc isKana(Code)
+[[nodiscard]] constexpr auto isMBLetter(Code c) noexcept {
+  return inCategory(c, UnicodeCategory::Letter);
+}
+/// \doc isKana(Code) (wide space is excluded by default)
+[[nodiscard]] constexpr auto isMBPunctuation(
+    Code c, bool includeSpace = false) noexcept {
+  return c == WideSpace ? includeSpace
+                        : inCategory(c, UnicodeCategory::Punctuation);
+}
+/// \doc isKana(Code) (includes wide space)
+[[nodiscard]] constexpr auto isRecognizedUtf8(Code c) noexcept {
+  return inCategory(c, RecognizedCategories);
+}
+
 // 'is' functions
 
 /// return true if `s` is empty or is one UTF-8 char of the expected type (set
@@ -312,6 +520,54 @@ template <typename... T>
 [[nodiscard]] bool isRecognizedUtf8(const String& s,
     bool sizeOne = true); ///< \doc isKana (includes wide spaces)
 
+// 'isAll' functions for Code values
+
+/// return true if `s` is empty or only contains expected type values
+/// \note a span created directly from a `U"..."` literal includes the final
+/// null so use a #CodeString (or `std::u32string_view`) instead
+[[nodiscard]] constexpr auto isAllKana(std::span<const Code> s) noexcept {
+  return allInCategory(s, KanaCategories);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllHiragana(std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::Hiragana);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllKatakana(std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::Katakana);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllKanji(std::span<const Code> s) noexcept {
+  return allInCategory(s, KanjiCategories);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllCommonKanji(
+    std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::CommonKanji);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllRareKanji(std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::RareKanji);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllMBSymbol(std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::Symbol);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllMBLetter(std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::Letter);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllMBPunctuation(
+    std::span<const Code> s) noexcept {
+  return allInCategory(s, UnicodeCategory::Punctuation);
+}
+/// \doc isAllKana(std::span<const Code>)
+[[nodiscard]] constexpr auto isAllRecognizedUtf8(
+    std::span<const Code> s) noexcept {
+  return allInCategory(s, RecognizedCategories);
+}
+
 // 'isAll' functions
 
 /// return true if `s` is empty or only contains expected type chars
@@ -326,5 +582,35 @@ template <typename... T>
 [[nodiscard]] bool isAllMBPunctuation(const String& s);  ///< \doc isAllKana
 [[nodiscard]] bool isAllRecognizedUtf8(const String& s); ///< \doc isAllKana
 
+// classifying text
+
+/// categories counted by classify() (the first 8 values match the categories
+/// used by the 'is' functions for single characters)
+enum class TextCategory : Enum::Size {
+  Hiragana,       ///< see isHiragana()
+  Katakana,       ///< see isKatakana()
+  CommonKanji,    ///< see isCommonKanji()
+  RareKanji,      ///< see isRareKanji()
+  MBPunctuation,  ///< see isMBPunctuation() (wide spaces are excluded)
+  MBSymbol,       ///< see isMBSymbol()
+  MBLetter,       ///< see isMBLetter()
+  Unrecognized,   ///< multi-byte values not in any of the above categories
+  Variants,       ///< variation selectors following a counted value
+  CombiningMarks, ///< Kana combining marks following a Kana they compose with
+  Errors, ///< invalid UTF-8 and non-spacing values that can't modify a value
+  None
+};
+
+/// map of counts per TextCategory populated by classify()
+using TextCategoryCounts = EnumMap<TextCategory, size_t>;
+
+/// add counts of values in `s` per TextCategory to `counts` in a single pass
+/// (Ascii isn't counted) \details this gives the same per-category results as
+/// calling the matching 'is' function for each 'MB character' (i.e., a value
+/// plus an optional variation selector or combining mark) like Stats does, and
+/// non-spacing values are counted as errors by the same rules as Utf8CharView.
+/// The counts are added to so the same map can be used for multiple buffers.
+void classify(std::span<const char> s, TextCategoryCounts& counts);
+
 /// \end_group
 } // namespace kanji_tools
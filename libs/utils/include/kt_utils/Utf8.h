@@ -2,6 +2,10 @@
 
 #include <kt_utils/String.h>
 
+#include <concepts>
+#include <iterator>
+#include <span>
+
 namespace kanji_tools { /// \utils_group{Utf8}
 /// UTF-8 conversion and validation functions and global UTF-8 related variables
 /// \note conversion was originally implemented using `#include <codecvt>`, but
@@ -108,12 +112,59 @@ template <typename T>
 /// \param sizeOne if true then `s` must consist of only one UTF-8 value
 /// \return #Utf8Result (`Valid` or 6 other values for invalid input)
 template <typename T>
+requires std::convertible_to<const T&, String>
 [[nodiscard]] auto validateUtf8(const T& s, bool sizeOne = false) noexcept {
   auto e{Utf8Result::Valid};
   validateMBUtf8(s, e, sizeOne);
   return e;
 }
 
+/// return value of validateUtf8(std::span<const char>)
+struct Utf8Validation final {
+  size_t offset;     ///< offset of the first error (or input size if valid)
+  Utf8Result result; ///< `Valid` or the type of the first error found
+};
+
+/// validate a whole buffer of UTF-8 (including single-byte Ascii) in one pass
+/// \details Examples:
+/// \code
+///   using Span = std::span<const char>;
+///   validateUtf8(Span{String{"abc"}}); // returns {3, Valid}
+///   validateUtf8(Span{String{"a\x80"}}); // returns {1, ContinuationByte}
+/// \endcode
+/// With SSE2, whole blocks (including multi-byte values) are checked at once
+/// by comparing byte ranges, otherwise runs of Ascii are skipped a block at a
+/// time. Unlike the other validate functions, `s` doesn't need to be null
+/// terminated (and can contain nulls).
+/// \note #String arguments match the single value validateUtf8() template so
+/// wrap them in a `std::span` to validate the whole string
+/// \param s UTF-8 input
+/// \return #Utf8Validation with the offset and type of the first error
+[[nodiscard]] Utf8Validation validateUtf8(std::span<const char> s) noexcept;
+
+/// functions for scanning UTF-8 a block at a time (using SSE2 if available) @{
+
+/// return the number of Ascii (single-byte) bytes at the start of `s`
+[[nodiscard]] size_t asciiPrefixSize(StringView s) noexcept;
+
+/// return the number of bytes in `s` that start UTF-8 values
+/// \param s UTF-8 input (doesn't need to be valid)
+/// \param onlyMB if true then only count bytes starting 'multi-byte' values,
+///     otherwise count all bytes that aren't continuation bytes
+[[nodiscard]] size_t countUtf8Starts(StringView s, bool onlyMB = true) noexcept;
+
+/// return position of the first two bytes in `s` equal to `a` or `b` (or the
+/// size of `s` if neither is found), `a` and `b` must both be two bytes long
+[[nodiscard]] size_t findEitherPair(
+    StringView s, StringView a, StringView b) noexcept;
+///@}
+
+/// return the size in bytes (2 to 4) of the multi-byte UTF-8 value at the start
+/// of `s` or `0` if `s` is empty, starts with Ascii or doesn't start with valid
+/// UTF-8 \details this matches validateMBUtf8() (with `sizeOne` false), but `s`
+/// doesn't need to be null terminated
+[[nodiscard]] size_t getMBUtf8Size(StringView s) noexcept;
+
 /// return true if input is valid 'multi-byte' UTF-8
 /// \param s UTF-8 input
 /// \param sizeOne if true then `s` must also consist of only one UTF-8 value
@@ -125,6 +176,106 @@ template <typename T>
 /// \param sizeOne if true then `s` must consist of only one UTF-8 value
 [[nodiscard]] bool isValidUtf8(const String&, bool sizeOne = false) noexcept;
 
+/// lazy forward range of #Code values over a #StringView \utils{Utf8}
+///
+/// Values are decoded one at a time while iterating so nothing is allocated and
+/// loops can stop at the first value they aren't interested in. Invalid UTF-8
+/// produces 'U+FFFD' values (same as fromUtf8()), but unlike fromUtf8() the
+/// input doesn't need to be null terminated (the size of the view is used).
+/// \details Example:
+/// \code
+///   for (auto i{Utf8View{"a猫"}.begin()}; i != Utf8View::Iterator{}; ++i)
+///     std::cout << toUnicode(*i) << ", offset: " << i.offset() << '\n';
+///   // prints "0061, offset: 0" and then "732B, offset: 1"
+/// \endcode
+class Utf8View final {
+public:
+  /// forward iterator returning #Code values (plus the byte offset of each
+  /// value in the view) \utils{Utf8}
+  class Iterator final {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Code;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() noexcept = default; ///< default ctor creates an 'end' iterator
+
+    /// return the current value
+    [[nodiscard]] auto operator*() const noexcept { return _code; }
+
+    /// return the offset (in bytes) of the current value from start of view
+    [[nodiscard]] auto offset() const noexcept {
+      return static_cast<size_t>(_cur - _begin);
+    }
+
+    /// return the number of bytes used by the current value (1 to 4)
+    [[nodiscard]] auto size() const noexcept {
+      return static_cast<size_t>(_next - _cur);
+    }
+
+    /// move to the next value (becomes an 'end' iterator at end of the view)
+    Iterator& operator++() noexcept {
+      _cur = _next;
+      decode();
+      return *this;
+    }
+
+    /// postfix increment
+    Iterator operator++(int) noexcept {
+      auto result{*this};
+      ++*this;
+      return result;
+    }
+
+    /// all 'end' iterators are equal, otherwise compare positions
+    [[nodiscard]] bool operator==(const Iterator& x) const noexcept {
+      return _cur == x._cur;
+    }
+
+  private:
+    friend Utf8View;
+
+    Iterator(const char* begin, const char* end) noexcept
+        : _begin{begin}, _cur{begin}, _end{end} {
+      decode();
+    }
+
+    /// decode value at `_cur` (Ascii is handled inline) or set `_cur` to null
+    /// if the end has been reached (so it equals a default 'end' iterator)
+    void decode() noexcept {
+      if (_cur == _end)
+        _cur = nullptr;
+      else if (isSingleByteChar(*_cur)) {
+        _code = static_cast<Code>(*_cur);
+        _next = _cur + 1;
+      } else
+        decodeMB();
+    }
+
+    void decodeMB() noexcept; ///< called by decode() for multi-byte UTF-8
+
+    const char* _begin{};
+    const char* _cur{};
+    const char* _next{};
+    const char* _end{};
+    Code _code{};
+  };
+
+  /// create a view over `s` (`s` must outlive the view and its iterators)
+  constexpr explicit Utf8View(StringView s) noexcept : _s{s} {}
+
+  /// return an iterator to the first value
+  [[nodiscard]] auto begin() const noexcept {
+    return Iterator{_s.data(), _s.data() + _s.size()};
+  }
+
+  /// return an 'end' iterator
+  [[nodiscard]] auto end() const noexcept { return Iterator{}; }
+
+private:
+  const StringView _s;
+};
+
 /// bit patterns used for processing UTF-8
 enum BitPatterns : uint8_t {
   Bit5 = 0b00'00'10'00,      ///< only bit 5 is set
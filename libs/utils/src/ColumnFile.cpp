@@ -1,10 +1,17 @@
 #include <kt_utils/ColumnFile.h>
 #include <kt_utils/Exception.h>
+#include <kt_utils/Utf8.h>
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
 #include <set>
-#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace kanji_tools {
 
@@ -21,6 +28,32 @@ bool ColumnFile::Column::operator==(const Column& rhs) const {
   return _number == rhs._number;
 }
 
+int ColumnFile::Mapping::map(const Path& p) noexcept {
+  const auto fd{::open(p.c_str(), O_RDONLY)};
+  if (fd < 0) return errno;
+  auto result{0};
+  if (struct stat st {}; ::fstat(fd, &st))
+    result = errno;
+  else if (st.st_size) {
+    if (auto* const data{::mmap(nullptr, static_cast<size_t>(st.st_size),
+            PROT_READ, MAP_PRIVATE, fd, 0)};
+        data == MAP_FAILED)
+      result = errno;
+    else {
+      _data = static_cast<const char*>(data);
+      _size = static_cast<size_t>(st.st_size);
+      // rows are read from start to end
+      ::madvise(data, _size, MADV_SEQUENTIAL);
+    }
+  }
+  ::close(fd);
+  return result;
+}
+
+ColumnFile::Mapping::~Mapping() {
+  if (_data) ::munmap(const_cast<char*>(_data), _size);
+}
+
 size_t ColumnFile::getColumnNumber(const String& name) {
   const auto i{_allColumns.find(name)};
   if (i == _allColumns.end()) return _allColumns[name] = _allColumns.size();
@@ -28,14 +61,17 @@ size_t ColumnFile::getColumnNumber(const String& name) {
 }
 
 ColumnFile::ColumnFile(const Path& p, const Columns& columns, char delim)
-    : _file{std::fstream(p)}, _delimiter{delim},
-      _fileName{p.filename().string()}, _rowValues{columns.size()},
+    : _delimiter{delim}, _fileName{p.filename().string()},
+      _rowViews(columns.size()), _rowValues{columns.size()},
+      _valueRows(columns.size()),
       _columnToPosition(_allColumns.size(), ColNotFound) {
   assert(_columnToPosition.size() == _allColumns.size()); // need () ctor
   if (columns.empty()) error("must specify at least one column");
   if (!std::filesystem::exists(p)) error("doesn't exist");
   if (!std::filesystem::is_regular_file(p)) error("not regular file");
-  if (String headerRow; std::getline(_file, headerRow)) {
+  if (const auto e{_mapping.map(p)}; e) error(std::strerror(e));
+  validateMapping();
+  if (StringView headerRow; nextLine(headerRow)) {
     ColNames colNames;
     for (auto& c : columns)
       if (!colNames.emplace(c.name(), c).second)
@@ -46,11 +82,26 @@ ColumnFile::ColumnFile(const Path& p, const Columns& columns, char delim)
     error("missing header row");
 }
 
-void ColumnFile::processHeaderRow(const String& row, ColNames& colNames) {
-  size_t pos{};
+void ColumnFile::validateMapping() {
+  const auto v{validateUtf8(std::span{_mapping.data(), _mapping.size()})};
+  if (v.result == Utf8Result::Valid) return;
+  // report the row (the header is row '0') and the byte within the row
+  const StringView before{_mapping.data(), v.offset};
+  _currentRow =
+      static_cast<size_t>(std::count(before.begin(), before.end(), '\n'));
+  const auto lineStart{before.rfind('\n')};
+  const auto byte{lineStart == StringView::npos ? v.offset
+                                                : v.offset - lineStart - 1};
+  error("invalid UTF-8 at byte " + std::to_string(byte));
+}
+
+void ColumnFile::processHeaderRow(StringView row, ColNames& colNames) {
   std::set<String> foundCols;
-  String header;
-  for (std::stringstream ss{row}; std::getline(ss, header, _delimiter); ++pos) {
+  for (size_t pos{}, start{}; start < row.size(); ++pos) {
+    auto end{row.find(_delimiter, start)};
+    if (end == StringView::npos) end = row.size();
+    const String header{row.substr(start, end - start)};
+    start = end + 1;
     if (foundCols.contains(header)) error("duplicate header '" + header + "'");
     const auto i{colNames.find(header)};
     if (i == colNames.end()) error("unrecognized header '" + header + "'");
@@ -73,86 +124,109 @@ void ColumnFile::verifyHeaderColumns(const ColNames& colNames) const {
   }
 }
 
+bool ColumnFile::nextLine(StringView& line) {
+  if (_offset >= _mapping.size()) return false;
+  const auto start{_mapping.data() + _offset};
+  const auto rest{_mapping.size() - _offset};
+  const auto end{static_cast<const char*>(std::memchr(start, '\n', rest))};
+  line = StringView{start, end ? static_cast<size_t>(end - start) : rest};
+  _offset += line.size() + 1;
+  return true;
+}
+
 bool ColumnFile::nextRow() {
-  if (String line; std::getline(_file, line)) {
-    ++_currentRow;
-    size_t i{};
-    String field;
-    for (std::stringstream ss{line}; std::getline(ss, field, _delimiter); ++i) {
-      if (i == _rowValues.size()) error("too many columns");
-      _rowValues[i] = field;
-    }
-    // the above call to 'getline' returns false when there's no more data, but
-    // it also returns false if it only reads a delimiter and then reaches the
-    // end of input so need a special case for an empty final column
-    if (i == _rowValues.size() - 1 &&
-        (i ? line.ends_with(_delimiter) : line.empty()))
-      _rowValues[_rowValues.size() - 1] = emptyString();
-    else if (i < _rowValues.size())
-      error("not enough columns");
-    return true;
+  StringView line;
+  if (!nextLine(line)) return false;
+  ++_currentRow;
+  // split fields in place ('find' uses 'memchr') - a line always has one more
+  // field than the number of delimiters it contains
+  size_t i{};
+  for (size_t start{};; ++i) {
+    if (i == _rowViews.size()) error("too many columns");
+    const auto end{line.find(_delimiter, start)};
+    _rowViews[i] = line.substr(start, end - start);
+    if (end == StringView::npos) break;
+    start = end + 1;
   }
-  return false;
+  if (++i < _rowViews.size()) error("not enough columns");
+  return true;
 }
 
-const String& ColumnFile::get(const Column& column) const {
+size_t ColumnFile::position(const Column& column) const {
   if (!_currentRow) error("'nextRow' must be called before calling 'get'");
   if (column.number() >= _columnToPosition.size())
     error("unrecognized column '" + column.name() + "'");
   const auto pos{_columnToPosition[column.number()]};
   if (pos == ColNotFound) error("invalid column '" + column.name() + "'");
+  return pos;
+}
+
+const String& ColumnFile::get(const Column& column) const {
+  const auto pos{position(column)};
+  if (_valueRows[pos] != _currentRow) {
+    _rowValues[pos] = _rowViews[pos]; // reuses capacity from previous rows
+    _valueRows[pos] = _currentRow;
+  }
   return _rowValues[pos];
 }
 
-bool ColumnFile::isEmpty(const Column& c) const { return get(c).empty(); }
+StringView ColumnFile::getView(const Column& column) const {
+  return _rowViews[position(column)];
+}
+
+bool ColumnFile::isEmpty(const Column& c) const { return getView(c).empty(); }
 
 uint64_t ColumnFile::getU64(const Column& c, uint64_t max) const {
-  return processU64(get(c), c, max);
+  return processU64(getView(c), c, max);
 }
 
 ColumnFile::OptU64 ColumnFile::getOptU64(const Column& c, uint64_t max) const {
-  auto& s{get(c)};
+  const auto s{getView(c)};
   if (s.empty()) return {};
   return processU64(s, c, max);
 }
 
 uint64_t ColumnFile::processU64(
-    const String& s, const Column& column, uint64_t max) const {
+    StringView s, const Column& column, uint64_t max) const {
   uint64_t i{};
-  try {
-    i = std::stoul(s);
-  } catch (...) {
-    error("failed to convert to unsigned number", column, s);
-  }
+  // 'from_chars' doesn't skip spaces or accept a sign so the whole value must
+  // be digits (it also returns an error instead of throwing for overflow)
+  const auto end{s.data() + s.size()};
+  if (const auto r{std::from_chars(s.data(), end, i)};
+      r.ec != std::errc{} || r.ptr != end)
+    error("failed to convert to unsigned number", column, String{s});
   if (max && max < i)
-    error("exceeded max value of " + std::to_string(max), column, s);
+    error("exceeded max value of " + std::to_string(max), column, String{s});
   return i;
 }
 
 bool ColumnFile::getBool(const Column& column) const {
-  auto& s{get(column)};
+  const auto s{getView(column)};
   if (s.size() == 1) switch (s[0]) {
     case 'Y':
     case 'T': return true;
     case 'N':
     case 'F': return false;
     }
-  if (!s.empty()) error("failed to convert to bool", column, s);
+  if (!s.empty()) error("failed to convert to bool", column, String{s});
   return false;
 }
 
 Code ColumnFile::getChar32(const Column& c) const {
-  return getChar32(c, get(c));
+  return getChar32(c, getView(c));
 }
 
-Code ColumnFile::getChar32(const Column& column, const String& s) const {
+Code ColumnFile::getChar32(const Column& column, StringView s) const {
   if (s.size() < UnicodeStringMinSize || s.size() > UnicodeStringMaxSize)
-    error("failed to convert to Code, size must be 4 or 5", column, s);
-  // want hex with capitals so can't use 'std::ishexnumber'
+    error("failed to convert to Code, size must be 4 or 5", column, String{s});
+  // want hex with capitals so can't use 'std::ishexnumber' (or rely on only
+  // 'from_chars' since it also accepts lower case)
   if (std::any_of(s.begin(), s.end(),
           [](auto i) { return i < '0' || i > 'F' || (i < 'A' && i > '9'); }))
-    error("failed to convert to Code, invalid hex", column, s);
-  return static_cast<Code>(std::stoi(s, nullptr, HexDigits));
+    error("failed to convert to Code, invalid hex", column, String{s});
+  uint32_t result{}; // at most 5 hex digits so always fits
+  std::from_chars(s.data(), s.data() + s.size(), result, HexDigits);
+  return static_cast<Code>(result);
 }
 
 void ColumnFile::error(const String& msg) const {
@@ -1,5 +1,7 @@
 #include <kt_utils/UnicodeBlock.h>
 
+#include <bit>
+
 namespace kanji_tools {
 
 std::ostream& operator<<(std::ostream& os, const UnicodeBlock::Version& v) {
@@ -21,81 +23,158 @@ std::ostream& operator<<(std::ostream& os, const UnicodeBlock& b) {
 // 'is' functions
 
 bool isKana(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, HiraganaBlocks, KatakanaBlocks);
+  return inWCharRange(s, sizeOne, KanaCategories);
 }
 
 bool isHiragana(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, HiraganaBlocks);
+  return inWCharRange(s, sizeOne, UnicodeCategory::Hiragana);
 }
 
 bool isKatakana(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, KatakanaBlocks);
+  return inWCharRange(s, sizeOne, UnicodeCategory::Katakana);
 }
 
 bool isKanji(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, CommonKanjiBlocks, RareKanjiBlocks);
+  return inWCharRange(s, sizeOne, KanjiCategories);
 }
 
 bool isCommonKanji(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, CommonKanjiBlocks);
+  return inWCharRange(s, sizeOne, UnicodeCategory::CommonKanji);
 }
 
 bool isRareKanji(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, RareKanjiBlocks);
+  return inWCharRange(s, sizeOne, UnicodeCategory::RareKanji);
 }
 
 bool isMBSymbol(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, SymbolBlocks);
+  return inWCharRange(s, sizeOne, UnicodeCategory::Symbol);
 }
 
 bool isMBLetter(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, LetterBlocks);
+  return inWCharRange(s, sizeOne, UnicodeCategory::Letter);
 }
 
 bool isMBPunctuation(const String& s, bool includeSpace, bool sizeOne) {
-  return s.starts_with("　") ? (includeSpace && (s.size() < 4 || !sizeOne))
-                             : inWCharRange(s, sizeOne, PunctuationBlocks);
+  return s.starts_with("　")
+             ? (includeSpace && (s.size() < 4 || !sizeOne))
+             : inWCharRange(s, sizeOne, UnicodeCategory::Punctuation);
 }
 
 bool isRecognizedUtf8(const String& s, bool sizeOne) {
-  return inWCharRange(s, sizeOne, HiraganaBlocks, CommonKanjiBlocks,
-      RareKanjiBlocks, KatakanaBlocks, PunctuationBlocks, SymbolBlocks,
-      LetterBlocks);
+  return inWCharRange(s, sizeOne, RecognizedCategories);
 }
 
 // 'isAll' functions
 
-bool isAllKana(const String& s) {
-  return inWCharRange(s, HiraganaBlocks, KatakanaBlocks);
-}
-
-bool isAllHiragana(const String& s) { return inWCharRange(s, HiraganaBlocks); }
+bool isAllKana(const String& s) { return inWCharRange(s, KanaCategories); }
 
-bool isAllKatakana(const String& s) { return inWCharRange(s, KatakanaBlocks); }
+bool isAllHiragana(const String& s) {
+  return inWCharRange(s, UnicodeCategory::Hiragana);
+}
 
-bool isAllKanji(const String& s) {
-  return inWCharRange(s, CommonKanjiBlocks, RareKanjiBlocks);
+bool isAllKatakana(const String& s) {
+  return inWCharRange(s, UnicodeCategory::Katakana);
 }
 
+bool isAllKanji(const String& s) { return inWCharRange(s, KanjiCategories); }
+
 bool isAllCommonKanji(const String& s) {
-  return inWCharRange(s, CommonKanjiBlocks);
+  return inWCharRange(s, UnicodeCategory::CommonKanji);
 }
 
 bool isAllRareKanji(const String& s) {
-  return inWCharRange(s, RareKanjiBlocks);
+  return inWCharRange(s, UnicodeCategory::RareKanji);
 }
 
-bool isAllMBSymbol(const String& s) { return inWCharRange(s, SymbolBlocks); }
+bool isAllMBSymbol(const String& s) {
+  return inWCharRange(s, UnicodeCategory::Symbol);
+}
 
-bool isAllMBLetter(const String& s) { return inWCharRange(s, LetterBlocks); }
+bool isAllMBLetter(const String& s) {
+  return inWCharRange(s, UnicodeCategory::Letter);
+}
 
 bool isAllMBPunctuation(const String& s) {
-  return inWCharRange(s, PunctuationBlocks);
+  return inWCharRange(s, UnicodeCategory::Punctuation);
 }
 
 bool isAllRecognizedUtf8(const String& s) {
-  return inWCharRange(s, HiraganaBlocks, CommonKanjiBlocks, RareKanjiBlocks,
-      KatakanaBlocks, PunctuationBlocks, SymbolBlocks, LetterBlocks);
+  return inWCharRange(s, RecognizedCategories);
+}
+
+// classifying text
+
+namespace {
+
+/// return TextCategory for a Code with UnicodeCategory `c` (`c` must not have
+/// NonSpacing set) - relies on the first 7 TextCategory values having the same
+/// order as UnicodeCategory bits
+[[nodiscard]] auto toTextCategory(UnicodeCategory c) {
+  using enum UnicodeCategory;
+  static_assert(to_underlying(TextCategory::Hiragana) ==
+                std::countr_zero(to_underlying(Hiragana)));
+  static_assert(to_underlying(TextCategory::MBLetter) ==
+                std::countr_zero(to_underlying(Letter)));
+  static_assert(to_underlying(TextCategory::Unrecognized) ==
+                std::countr_zero(to_underlying(NonSpacing)));
+  return c == None ? TextCategory::Unrecognized
+                   : to_enum<TextCategory>(static_cast<Enum::Size>(
+                         std::countr_zero(to_underlying(c))));
+}
+
+/// return true if Kana combining mark `mark` composes with `c` (these are the
+/// same Kana as the ones composed by Utf8CharView in the 'kana' library)
+[[nodiscard]] constexpr bool isComposable(Code c, Code mark) {
+  constexpr std::u32string_view Dakuten{
+      U"うかきくけこさしすせそたちつてとはひふへほ"},
+      HanDakuten{U"はひふへほ"};
+  // Katakana have the same layout as Hiragana so check them as Hiragana
+  if (c >= U'ァ' && c <= U'ヶ') c -= U'ァ' - U'ぁ';
+  return (mark == CombiningVoicedChar ? Dakuten : HanDakuten).find(c) !=
+         std::u32string_view::npos;
+}
+
+static_assert(isComposable(U'か', CombiningVoicedChar) &&
+              isComposable(U'ウ', CombiningVoicedChar) &&
+              isComposable(U'ホ', CombiningSemiVoicedChar) &&
+              !isComposable(U'か', CombiningSemiVoicedChar) &&
+              !isComposable(U'ワ', CombiningVoicedChar) &&
+              !isComposable(U'　', CombiningVoicedChar));
+
+} // namespace
+
+void classify(std::span<const char> s, TextCategoryCounts& result) {
+  // Utf8View returns U+FFFD for invalid UTF-8 so check if it's really U+FFFD
+  static constexpr Code ReplacementCode{U'\xfffd'};
+  static constexpr StringView Replacement{"\xef\xbf\xbd"};
+  // 'base' is the last multi-byte value counted (or 0 if a non-spacing value
+  // can't follow, i.e., at the start, after Ascii, errors or non-spacing)
+  Code base{};
+  for (auto i{Utf8View{{s.data(), s.size()}}.begin()};
+       i != Utf8View::Iterator{}; ++i) {
+    const auto c{*i};
+    if (isSingleByteChar(c))
+      base = 0;
+    else if (c == ReplacementCode &&
+             StringView{s.data() + i.offset(), i.size()} != Replacement) {
+      ++result[TextCategory::Errors];
+      base = 0;
+    } else if (const auto category{getCategory(c)};
+               hasValue(category & UnicodeCategory::NonSpacing)) {
+      // Kana combining marks are also in the Hiragana block so check for them
+      // (and variation selectors) before checking other categories
+      if (c == CombiningVoicedChar || c == CombiningSemiVoicedChar)
+        ++result[base && isComposable(base, c) ? TextCategory::CombiningMarks
+                                               : TextCategory::Errors];
+      else
+        ++result[base ? TextCategory::Variants : TextCategory::Errors];
+      base = 0;
+    } else {
+      base = c;
+      // wide space is 'recognized', but isn't counted as punctuation
+      if (c != WideSpace) ++result[toTextCategory(category)];
+    }
+  }
 }
 
 } // namespace kanji_tools
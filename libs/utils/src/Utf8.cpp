@@ -1,7 +1,16 @@
 #include <kt_utils/Utf8.h>
 
+#include <algorithm>
 #include <array>
 #include <bit>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace kanji_tools {
 
@@ -51,8 +60,12 @@ constexpr uInt Shift12{Shift6 * 2}, Shift18{Shift6 * 3};
 
 /// advances `u` to the next byte and returns true it it starts with '10', i.e.,
 /// a continuation byte
-[[nodiscard]] constexpr auto getNextByte(const uint8_t*& u) noexcept {
-  return std::countl_one(*++u) == 1;
+/// \param u pointer to the current byte
+/// \param end end of input, null for null-terminated input (since the null at
+///     the end isn't a continuation byte)
+[[nodiscard]] constexpr auto getNextByte(
+    const uint8_t*& u, const uint8_t* end = {}) noexcept {
+  return ++u != end && std::countl_one(*u) == 1;
 }
 
 /// allow casting `uInt` to #Code or `wchar_t`, used by convertFromUtf8()
@@ -103,8 +116,10 @@ constexpr std::array WCharVals{toWChar(ErrorReplacement), toWChar(MinSurrogate),
 
 template <typename T> using Consts = std::array<T, Char32Vals.size()>;
 
+/// convert one value, `end` is passed to getNextByte()
 template <typename T>
-[[nodiscard]] T convertOneUtf8(const uint8_t*& u, const Consts<T>& v) noexcept {
+[[nodiscard]] T convertOneUtf8(
+    const uint8_t*& u, const Consts<T>& v, const uint8_t* end = {}) noexcept {
   const auto utfLen{std::countl_one(*u)};
   if (!utfLen) return {*u++}; // single byte UTF-8 case (Ascii)
   if (utfLen == 1 || utfLen > 4) {
@@ -112,13 +127,13 @@ template <typename T>
     return v[Err]; // 1st byte was '10...' or more than four '1's
   }                // GCOV_EXCL_STOP
   uInt byte1{*u};
-  if (!getNextByte(u)) return v[Err]; // 2nd byte not '10...'
+  if (!getNextByte(u, end)) return v[Err]; // 2nd byte not '10...'
   uInt byte2 = *u ^ Bit1;
   if (utfLen > 2) {
-    if (!getNextByte(u)) return v[Err]; // 3rd not '10...'
+    if (!getNextByte(u, end)) return v[Err]; // 3rd not '10...'
     if (utfLen == 4) {
       uInt byte3 = *u ^ Bit1;
-      if (!getNextByte(u)) return v[Err]; // 4th byte not '10...'
+      if (!getNextByte(u, end)) return v[Err]; // 4th byte not '10...'
       const auto t{fourByteUtf8<T>(byte1, byte2, byte3, u++)};
       // return Error if 't' is 'overlong' or beyond max Unicode range
       return t > v[MaxThree] && t <= v[MaxUni] ? t : v[Err];
@@ -132,16 +147,287 @@ template <typename T>
                                : v[Err];
 }
 
+/// number of bytes checked at a time by convertAscii() and the scanning
+/// functions (16 when SSE2 is available, otherwise 8 using a `uint64_t` load)
+#ifdef __SSE2__
+constexpr size_t BlockSize{sizeof(__m128i)};
+#else
+constexpr size_t BlockSize{sizeof(uint64_t)};
+#endif
+
+// The following functions return a 'ByteMask' with a flag for each byte of the
+// block starting at `u` that matches a condition. With SSE2, bit 'i' is set for
+// byte 'i' (via 'movemask'), otherwise 'SWAR' (SIMD within a register) is used
+// on a `uint64_t` and the high bit of each matching byte is set. In both cases
+// countBytes() returns the number of matches and firstByte() returns the index
+// of the first match.
+
+#ifdef __SSE2__
+using ByteMask = uint32_t;
+
+[[nodiscard]] auto loadBlock(const uint8_t* u) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(u));
+}
+
+[[nodiscard]] ByteMask toMask(__m128i x) noexcept {
+  return static_cast<ByteMask>(_mm_movemask_epi8(x));
+}
+
+/// return mask of bytes with the high bit set, i.e., non-Ascii
+[[nodiscard]] ByteMask highMask(const uint8_t* u) noexcept {
+  return toMask(loadBlock(u));
+}
+
+/// return mask of bytes that start multi-byte values (high bits are '11')
+[[nodiscard]] ByteMask startMask(const uint8_t* u) noexcept {
+  // adding 'x' to itself shifts each byte left by one
+  const auto x{loadBlock(u)};
+  return toMask(_mm_and_si128(x, _mm_add_epi8(x, x)));
+}
+
+/// return mask of continuation bytes (high bits are '10')
+[[nodiscard]] ByteMask continuationMask(const uint8_t* u) noexcept {
+  const auto x{loadBlock(u)};
+  return toMask(_mm_andnot_si128(_mm_add_epi8(x, x), x));
+}
+
+/// return mask of bytes that start a pair equal to `a` or `b` (bytes at `u + 1`
+/// are compared with the second byte of each pair so one more byte is read)
+[[nodiscard]] ByteMask pairMask(
+    const uint8_t* u, const uint8_t* a, const uint8_t* b) noexcept {
+  const auto x{loadBlock(u)}, y{loadBlock(u + 1)};
+  const auto eq{[](__m128i v, uint8_t c) {
+    return _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(c)));
+  }};
+  return toMask(_mm_or_si128(_mm_and_si128(eq(x, a[0]), eq(y, a[1])),
+      _mm_and_si128(eq(x, b[0]), eq(y, b[1]))));
+}
+
+[[nodiscard]] size_t firstByte(ByteMask m) noexcept {
+  return static_cast<size_t>(std::countr_zero(m));
+}
+#else
+using ByteMask = uint64_t;
+
+constexpr ByteMask HighBits{0x80'80'80'80'80'80'80'80},
+    LowBits{0x7f'7f'7f'7f'7f'7f'7f'7f}, OneBits{0x01'01'01'01'01'01'01'01};
+
+[[nodiscard]] ByteMask loadBlock(const uint8_t* u) noexcept {
+  ByteMask x{};
+  std::memcpy(&x, u, BlockSize); // compiles to a single unaligned load
+  return x;
+}
+
+/// return mask of bytes with the high bit set, i.e., non-Ascii
+[[nodiscard]] ByteMask highMask(const uint8_t* u) noexcept {
+  return loadBlock(u) & HighBits;
+}
+
+/// return mask of bytes that start multi-byte values (high bits are '11')
+[[nodiscard]] ByteMask startMask(const uint8_t* u) noexcept {
+  const auto x{loadBlock(u)};
+  return x & x << 1U & HighBits;
+}
+
+/// return mask of continuation bytes (high bits are '10')
+[[nodiscard]] ByteMask continuationMask(const uint8_t* u) noexcept {
+  const auto x{loadBlock(u)};
+  return x & ~(x << 1U) & HighBits;
+}
+
+/// return mask of zero bytes in `x` (exact, i.e., no false positives)
+[[nodiscard]] constexpr ByteMask zeroMask(ByteMask x) noexcept {
+  return ~(((x & LowBits) + LowBits) | x | LowBits);
+}
+
+/// return mask of bytes that start a pair equal to `a` or `b` (bytes at `u + 1`
+/// are compared with the second byte of each pair so one more byte is read)
+[[nodiscard]] ByteMask pairMask(
+    const uint8_t* u, const uint8_t* a, const uint8_t* b) noexcept {
+  const auto x{loadBlock(u)}, y{loadBlock(u + 1)};
+  const auto eq{
+      [](ByteMask v, uint8_t c) { return zeroMask(v ^ c * OneBits); }};
+  return (eq(x, a[0]) & eq(y, a[1])) | (eq(x, b[0]) & eq(y, b[1]));
+}
+
+[[nodiscard]] size_t firstByte(ByteMask m) noexcept {
+  return static_cast<size_t>(std::endian::native == std::endian::little
+                                 ? std::countr_zero(m)
+                                 : std::countl_zero(m)) /
+         CHAR_BIT;
+}
+#endif
+
+[[nodiscard]] size_t countBytes(ByteMask m) noexcept {
+  return static_cast<size_t>(std::popcount(m));
+}
+
+/// return true if `BlockSize` bytes starting at `u` are all Ascii
+[[nodiscard]] bool isAsciiBlock(const uint8_t* u) noexcept {
+  return !highMask(u);
+}
+
+#ifdef __SSE2__
+/// return mask of bytes in `x` equal to `c`
+[[nodiscard]] ByteMask equalMask(__m128i x, uint8_t c) noexcept {
+  return toMask(_mm_cmpeq_epi8(x, _mm_set1_epi8(static_cast<char>(c))));
+}
+
+/// return mask of bytes in `x` that are at least `c` (unsigned)
+[[nodiscard]] ByteMask atLeastMask(__m128i x, uint8_t c) noexcept {
+  return toMask(
+      _mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8(static_cast<char>(c))), x));
+}
+
+/// positions (past the end of a block) that the next block must satisfy, one
+/// bit per byte like a 'ByteMask' - set by validBlock() for sequences that
+/// cross into the next block
+struct BlockCarry final {
+  uint32_t continuation{}; ///< must be continuation bytes
+  uint32_t minA0{}, min90{}; ///< must be at least 0xa0 (or 0x90)
+  uint32_t max9F{}, max8F{}; ///< must be at most 0x9f (or 0x8f)
+};
+
+/// return true if the block at `u` is valid UTF-8 by checking byte ranges for
+/// the whole block at once (sequences can cross into the next block which is
+/// tracked by `carry`) \details lead bytes determine which of the following
+/// bytes must be continuation bytes and the second byte after some leads has
+/// a smaller range ('E0' and 'F0' are overlong below 'A0' and '90', 'ED' is a
+/// surrogate above '9F' and 'F4' is past #MaxUnicode above '8F'). Leads 'C0',
+/// 'C1' (always overlong) and 'F5' to 'FF' are never valid.
+[[nodiscard]] bool validBlock(const uint8_t* u, BlockCarry& carry) noexcept {
+  static constexpr uint32_t BlockBits{(1U << BlockSize) - 1};
+  const auto x{loadBlock(u)};
+  const auto leads{atLeastMask(x, 0xc0)}, e0Plus{atLeastMask(x, 0xe0)},
+      f0Plus{atLeastMask(x, 0xf0)};
+  if ((leads & ~atLeastMask(x, 0xc2)) | atLeastMask(x, 0xf5)) return false;
+  const auto continuation{leads << 1U | e0Plus << 2U | f0Plus << 3U |
+                          carry.continuation};
+  if ((continuation & BlockBits) != continuationMask(u)) return false;
+  const auto minA0{equalMask(x, 0xe0) << 1U | carry.minA0},
+      min90{equalMask(x, 0xf0) << 1U | carry.min90},
+      max9F{equalMask(x, 0xed) << 1U | carry.max9F},
+      max8F{equalMask(x, 0xf4) << 1U | carry.max8F};
+  const auto a0Plus{atLeastMask(x, 0xa0)}, ninetyPlus{atLeastMask(x, 0x90)};
+  if (((minA0 & ~a0Plus) | (min90 & ~ninetyPlus) | (max9F & a0Plus) |
+          (max8F & ninetyPlus)) &
+      BlockBits)
+    return false;
+  carry = {continuation >> BlockSize, minA0 >> BlockSize, min90 >> BlockSize,
+      max9F >> BlockSize, max8F >> BlockSize};
+  return true;
+}
+#endif
+
+/// if `BlockSize` bytes starting at `u` are all Ascii then widen them into
+/// `out` and return true, otherwise leave `out` unchanged and return false
+template <typename T>
+[[nodiscard]] bool convertAsciiBlock(const uint8_t* u, T* out) noexcept {
+  static_assert(sizeof(T) == sizeof(uint32_t));
+  if (!isAsciiBlock(u)) return false;
+#ifdef __SSE2__
+  const auto x{_mm_loadu_si128(reinterpret_cast<const __m128i*>(u))};
+  const auto zero{_mm_setzero_si128()};
+  const auto lo{_mm_unpacklo_epi8(x, zero)}, hi{_mm_unpackhi_epi8(x, zero)};
+  const auto o{reinterpret_cast<__m128i*>(out)};
+  _mm_storeu_si128(o, _mm_unpacklo_epi16(lo, zero));
+  _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo, zero));
+  _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi, zero));
+  _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi, zero));
+#else
+  std::copy(u, u + BlockSize, out);
+#endif
+  return true;
+}
+
+/// bulk decoding helper that tracks input and output positions, used by
+/// convertFromUtf8() for runs of Ascii and runs of three byte UTF-8 (which
+/// covers all Kana and almost all Kanji)
+template <typename T> class Utf8Decoder final {
+public:
+  Utf8Decoder(const uint8_t* u, const uint8_t* end, T* out, const T* outEnd)
+      : _u{u}, _end{end}, _out{out}, _outEnd{outEnd} {}
+
+  [[nodiscard]] auto out() const noexcept { return _out; }
+  [[nodiscard]] auto ascii() const noexcept { return *_u <= MaxAscii; }
+  [[nodiscard]] auto done() const noexcept {
+    return _u == _end || _out == _outEnd;
+  }
+
+  /// convert Ascii starting at `_u` (which must be Ascii), whole blocks are
+  /// converted at a time when there's enough input and space in the output
+  void convertAscii() noexcept {
+    while (room(BlockSize) && convertAsciiBlock(_u, _out)) {
+      _u += BlockSize;
+      _out += BlockSize;
+    }
+    for (; !done() && *_u <= MaxAscii; ++_u) *_out++ = *_u;
+  }
+
+  /// convert a run of complete three byte sequences and return false if no
+  /// values were converted (so the caller should fall back to convertOne())
+  [[nodiscard]] bool convertThreeBytes(const Consts<T>& v) noexcept {
+    const auto start{_out};
+    for (; room(ThreeByteSize) && isThreeBytes(); _u += ThreeByteSize) {
+      const auto t{threeByteUtf8<T>(_u[0], _u[1] ^ Bit1, _u + 2)};
+      // same 'overlong' and 'surrogate' checks as convertOneUtf8()
+      *_out++ = t > v[MaxTwo] && (t < v[MinSur] || t > v[MaxSur]) ? t : v[Err];
+    }
+    return _out != start;
+  }
+
+  /// convert one value using convertOneUtf8() (for error and edge cases), pass
+  /// `_end` since input may have been truncated before its null terminator
+  void convertOne(const Consts<T>& v) noexcept {
+    *_out++ = convertOneUtf8(_u, v, _end);
+  }
+
+private:
+  static constexpr size_t ThreeByteSize{3};
+
+  /// return true if there are at least `n` bytes of input left as well as
+  /// space for `n` more values in the output (only need to check 'out' space
+  /// for Ascii, but keep one function for simplicity)
+  [[nodiscard]] bool room(size_t n) const noexcept {
+    return static_cast<size_t>(_end - _u) >= n &&
+           static_cast<size_t>(_outEnd - _out) >= n;
+  }
+
+  [[nodiscard]] bool isThreeBytes() const noexcept {
+    return (_u[0] & FourBits) == ThreeBits && (_u[1] & TwoBits) == Bit1 &&
+           (_u[2] & TwoBits) == Bit1;
+  }
+
+  const uint8_t* _u;
+  const uint8_t* const _end;
+  T* _out;
+  const T* const _outEnd;
+};
+
 /// `R` is a sequence (so u32string or wstring) and `T` is #Code or `wchar_t`
+/// \details the result is sized up front (it can't have more values than there
+/// are bytes in `s`) and then trimmed at the end to avoid repeated appending
 template <typename R, typename T = typename R::value_type>
 [[nodiscard]] R convertFromUtf8(
     const char* s, size_t maxSize, const Consts<T>& v) {
   R result;
   if (!s || !*s) return result;
-  auto u{reinterpret_cast<const uint8_t*>(s)};
+  // each value uses at most 'MaxMBSize' bytes so there's no need to look past
+  // 'maxSize * MaxMBSize' bytes for the end of 's' (which could be much longer)
+  static constexpr auto MaxBound{
+      std::numeric_limits<size_t>::max() / MaxMBSize};
+  const auto len{maxSize ? strnlen(s, std::min(maxSize, MaxBound) * MaxMBSize)
+                         : std::strlen(s)};
+  result.resize(maxSize ? std::min(len, maxSize) : len);
+  const auto u{reinterpret_cast<const uint8_t*>(s)};
+  Utf8Decoder<T> d{u, u + len, result.data(), result.data() + result.size()};
   do {
-    result += convertOneUtf8(u, v);
-  } while (*u && (!maxSize || result.size() < maxSize));
+    if (d.ascii())
+      d.convertAscii();
+    else if (!d.convertThreeBytes(v))
+      d.convertOne(v);
+  } while (!d.done());
+  result.resize(static_cast<size_t>(d.out() - result.data()));
   return result;
 }
 
@@ -197,6 +483,32 @@ template <typename T>
                            : err(Utf8Result::StringTooLong);
 }
 
+/// validate one multi-byte sequence starting at `u` which has `size` bytes
+/// left in the buffer, returns the number of bytes in the sequence or `0` if
+/// it's not valid (in which case `error` is set)
+[[nodiscard]] size_t validateOneMB(
+    const uint8_t* u, size_t size, Utf8Result& error) noexcept {
+  const auto err{[&error](auto e) {
+    error = e;
+    return MBUtf8Result::NotValid;
+  }};
+  if ((*u & TwoBits) == Bit1) {
+    error = Utf8Result::ContinuationByte;
+    return 0;
+  }
+  // validateMB() reads at most 'MaxMBSize' bytes and stops at the first byte
+  // that isn't a continuation byte so copy the end of a buffer into a zero
+  // padded array (span input isn't required to be null terminated)
+  std::array<uint8_t, MaxMBSize + 1> padded{};
+  if (size < MaxMBSize) {
+    std::copy_n(u, size, padded.begin());
+    u = padded.data();
+  }
+  return validateMB(err, u, false) == MBUtf8Result::Valid
+             ? static_cast<size_t>(std::countl_one(*u))
+             : 0;
+}
+
 } // namespace
 
 CodeString fromUtf8(const char* s, size_t maxSize) {
@@ -269,6 +581,84 @@ MBUtf8Result validateMBUtf8(
   return validateMBUtf8(s.c_str(), error, sizeOne);
 }
 
+Utf8Validation validateUtf8(std::span<const char> s) noexcept {
+  auto error{Utf8Result::Valid};
+  const auto start{reinterpret_cast<const uint8_t*>(s.data())};
+  const auto end{start + s.size()};
+  const auto remaining{
+      [end](const uint8_t* u) { return static_cast<size_t>(end - u); }};
+  auto u{start};
+#ifdef __SSE2__
+  // check whole blocks using byte ranges (including multi-byte values) and
+  // then use the loop below for the rest of the input or to find the exact
+  // offset and type of an error, i.e., go back to the start of a sequence that
+  // crosses into the block that failed (or into the tail of the input)
+  for (BlockCarry carry; remaining(u) >= BlockSize && validBlock(u, carry);)
+    u += BlockSize;
+  while (u > start && (u[-1] & TwoBits) == Bit1) --u;
+  if (u > start && (u[-1] & TwoBits) == TwoBits) --u;
+#endif
+  while (u < end)
+    if (remaining(u) >= BlockSize && isAsciiBlock(u))
+      u += BlockSize;
+    else if (*u <= MaxAscii)
+      ++u;
+    else if (const auto n{validateOneMB(u, remaining(u), error)}; n)
+      u += n;
+    else
+      return {static_cast<size_t>(u - start), error};
+  return {s.size(), error};
+}
+
+size_t asciiPrefixSize(StringView s) noexcept {
+  const auto u{reinterpret_cast<const uint8_t*>(s.data())};
+  size_t i{};
+  for (; i + BlockSize <= s.size(); i += BlockSize)
+    if (const auto m{highMask(u + i)}; m) return i + firstByte(m);
+  while (i < s.size() && u[i] <= MaxAscii) ++i;
+  return i;
+}
+
+size_t countUtf8Starts(StringView s, bool onlyMB) noexcept {
+  const auto u{reinterpret_cast<const uint8_t*>(s.data())};
+  size_t i{}, result{};
+  // when 'onlyMB' is false count all bytes that aren't continuation bytes
+  for (; i + BlockSize <= s.size(); i += BlockSize)
+    result += onlyMB ? countBytes(startMask(u + i))
+                     : BlockSize - countBytes(continuationMask(u + i));
+  for (; i < s.size(); ++i)
+    result += onlyMB ? (u[i] & TwoBits) == TwoBits : (u[i] & TwoBits) != Bit1;
+  return result;
+}
+
+size_t findEitherPair(StringView s, StringView a, StringView b) noexcept {
+  assert(a.size() == 2 && b.size() == 2);
+  const auto u{reinterpret_cast<const uint8_t*>(s.data())};
+  const auto x{reinterpret_cast<const uint8_t*>(a.data())},
+      y{reinterpret_cast<const uint8_t*>(b.data())};
+  size_t i{};
+  // each block also reads the byte after it (for the second byte of a pair)
+  for (; i + BlockSize < s.size(); i += BlockSize)
+    if (const auto m{pairMask(u + i, x, y)}; m) return i + firstByte(m);
+  for (; i + 1 < s.size(); ++i)
+    if (const auto p{s.substr(i, 2)}; p == a || p == b) return i;
+  return s.size();
+}
+
+size_t getMBUtf8Size(StringView s) noexcept {
+  if (s.empty() || isSingleByteChar(s[0])) return 0;
+  auto error{Utf8Result::Valid};
+  return validateOneMB(
+      reinterpret_cast<const uint8_t*>(s.data()), s.size(), error);
+}
+
+void Utf8View::Iterator::decodeMB() noexcept {
+  auto u{reinterpret_cast<const uint8_t*>(_cur)};
+  const auto end{reinterpret_cast<const uint8_t*>(_end)};
+  _code = convertOneUtf8(u, Char32Vals, end);
+  _next = reinterpret_cast<const char*>(u);
+}
+
 bool isValidMBUtf8(const String& s, bool sizeOne) noexcept {
   return validateMBUtf8(s, sizeOne) == MBUtf8Result::Valid;
 }
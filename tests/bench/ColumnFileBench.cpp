@@ -0,0 +1,75 @@
+#include <kt_utils/Args.h>
+#include <kt_utils/ColumnFile.h>
+#include <kt_utils/Exception.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+// times reading the numeric columns of a generated file with ColumnFile, i.e.,
+// getChar32, getU64, getU8 and getOptU8 (the same kinds of columns that are in
+// 'ucd.txt'). Build with '-DBUILD_BENCHMARKS=ON' and run at different commits
+// to compare. Optional args are the number of rows (default 500,000) and the
+// number of runs (default 3).
+
+namespace kanji_tools {
+
+namespace {
+
+constexpr size_t DefaultRows{500'000}, DefaultRuns{3};
+
+/// write a file with a header row plus `rows` rows of numeric columns
+void writeFile(const ColumnFile::Path& p, size_t rows) {
+  static constexpr uint32_t Radicals{214}, MaxStrokes{30}, Codes{20'000};
+  std::mt19937 gen{1}; // NOLINT: fixed seed so runs use the same data
+  std::ofstream of{p};
+  of << "Code\tRadical\tStrokes\tVStrokes\tNumber\n";
+  for (size_t i{}; i < rows; ++i) {
+    of << std::hex << std::uppercase << 0x4e00 + i % Codes << std::dec << '\t'
+       << 1 + gen() % Radicals << '\t' << 1 + gen() % MaxStrokes << '\t';
+    if (i % 3) of << gen() % MaxStrokes; // leave some optional values empty
+    of << '\t' << i << '\n';
+  }
+}
+
+[[nodiscard]] size_t getArg(const Args& args, Args::Size i, size_t def) {
+  return args.size() > i ? std::stoul(args[i]) : def;
+}
+
+void run(const Args& args) {
+  const auto rows{getArg(args, 1, DefaultRows)},
+      runs{getArg(args, 2, DefaultRuns)};
+  const auto file{
+      std::filesystem::temp_directory_path() / "columnFileBench.txt"};
+  writeFile(file, rows);
+  const ColumnFile::Column code{"Code"}, radical{"Radical"},
+      strokes{"Strokes"}, vStrokes{"VStrokes"}, number{"Number"};
+  for (size_t i{}; i < runs; ++i) {
+    const auto start{std::chrono::steady_clock::now()};
+    uint64_t sum{}; // make sure values are used
+    ColumnFile f{file, {code, radical, strokes, vStrokes, number}};
+    while (f.nextRow())
+      sum += f.getChar32(code) + f.getU64(radical) + f.getU8(strokes) +
+             f.getOptU8(vStrokes).value_or(0) + f.getU64(number);
+    const std::chrono::duration<double> secs{
+        std::chrono::steady_clock::now() - start};
+    std::cout << "run " << i + 1 << ": rows=" << f.currentRow()
+              << ", sum=" << sum << ", secs=" << secs.count() << '\n';
+  }
+  std::filesystem::remove(file);
+}
+
+} // namespace
+
+} // namespace kanji_tools
+
+int main(int argc, const char** argv) {
+  try {
+    kanji_tools::run({argc, argv});
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <kt_kana/Converter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// This test replaces global 'new' and 'delete' to count heap allocations so it
+// is built as its own small program (instead of being part of 'kanaTest') to
+// avoid changing the allocator for all the other tests. Replacing them also
+// hides allocations from AddressSanitizer so the test is skipped in that case.
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define KT_ASAN
+#endif
+#elif defined(__SANITIZE_ADDRESS__)
+#define KT_ASAN
+#endif
+
+#ifndef KT_ASAN
+
+namespace {
+
+std::atomic<size_t> allocations; // NOLINT
+
+[[nodiscard]] void* allocate(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto* const p{std::malloc(size ? size : 1)}; p) return p; // NOLINT
+  throw std::bad_alloc{};
+}
+
+[[nodiscard]] void* allocate(size_t size, std::align_val_t align) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto a{static_cast<size_t>(align)};
+  // size passed to 'aligned_alloc' must be a non-zero multiple of 'a'
+  const auto rounded{size ? (size + a - 1) / a * a : a};
+  if (auto* const p{std::aligned_alloc(a, rounded)}; p) return p;
+  throw std::bad_alloc{};
+}
+
+} // namespace
+
+// 'new' and 'delete' replacements (all use 'malloc' and 'free') @{
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t a) {
+  return allocate(size, a);
+}
+void* operator new[](size_t size, std::align_val_t a) {
+  return allocate(size, a);
+}
+void operator delete(void* p) noexcept { std::free(p); }   // NOLINT
+void operator delete[](void* p) noexcept { std::free(p); } // NOLINT
+void operator delete(void* p, size_t) noexcept { std::free(p); }   // NOLINT
+void operator delete[](void* p, size_t) noexcept { std::free(p); } // NOLINT
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p); // NOLINT
+}
+void operator delete[](void* p, std::align_val_t) noexcept {
+  std::free(p); // NOLINT
+}
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  std::free(p); // NOLINT
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+  std::free(p); // NOLINT
+} ///@}
+
+#endif
+
+namespace kanji_tools {
+
+TEST(ConverterAllocTest, NoAllocationsWhenReusingOutput) {
+#ifdef KT_ASAN
+  GTEST_SKIP() << "allocations aren't counted when using AddressSanitizer";
+#else
+  // cSpell:disable
+  const StringView input{"kon'nichiha, tōkyō desu ne. kippu kan'i\n"
+                         "ニンジャ ちょっと まっち ーかゝ き\xef\xb8\x80 ば"};
+  // cSpell:enable
+  Converter converter;
+  String out;
+  for (const auto target : CharTypes) {
+    converter.target(target);
+    const auto run{[&converter, &input, &out] {
+      converter.convert(input, out);
+      for (const auto source : CharTypes) {
+        out.clear();
+        converter.convert(source, input, out);
+      }
+      out.clear();
+    }};
+    run(); // first run grows 'out' and initializes static tables
+    const auto before{allocations.load()};
+    run();
+    EXPECT_EQ(allocations.load(), before) << toString(target);
+  }
+#endif
+}
+
+} // namespace kanji_tools
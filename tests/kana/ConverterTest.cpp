@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 #include <kt_kana/Converter.h>
 #include <kt_kana/Kana.h>
+#include <kt_tests/WhatMismatch.h>
 #include <kt_utils/UnicodeBlock.h>
 
+#include <future>
+#include <random>
+
 namespace kanji_tools {
 
 namespace {
@@ -172,6 +176,22 @@ TEST_F(ConverterTest, ConvertRomajiToHiragana) {
   EXPECT_EQ(romajiToHiragana("[サメはkowai!]"), "「サメはこわい！」");
 }
 
+TEST_F(ConverterTest, AllRomajiAnyCase) {
+  for (auto& i : Kana::getMap(CharType::Romaji)) {
+    auto& hiragana{i.second->hiragana()};
+    const String romaji{i.first};
+    EXPECT_EQ(romajiToHiragana(romaji), hiragana) << romaji;
+    EXPECT_EQ(romajiToHiragana(toUpper(romaji)), hiragana) << romaji;
+    EXPECT_EQ(romajiToHiragana(firstUpper(romaji)), hiragana) << romaji;
+  }
+  // sokuon, 'n' and macron rules also ignore case - cSpell:disable
+  EXPECT_EQ(romajiToHiragana("KiTTe KaNNoN TōKYō"),
+      "きって　かんのん　とーきょー");
+  EXPECT_EQ(romajiToKatakana("MATCHI KOTCHI"), "マッチ　コッチ");
+  // non-letters don't match any Rōmaji
+  EXPECT_EQ(romajiToHiragana("k_a k@"), "k＿あ　k＠"); // cSpell:enable
+}
+
 TEST_F(ConverterTest, ConvertRomajiToKatakana) {
   EXPECT_EQ(romajiToKatakana("i"), "イ");
   EXPECT_EQ(romajiToKatakana("ke"), "ケ");
@@ -272,17 +292,36 @@ TEST_F(ConverterTest, HepburnAndKunrei) {
   // surprising results (see 'HepburnVersusKunrei' test below to see all values)
 }
 
+TEST_F(ConverterTest, ApostropheAndSokuonForAllKana) {
+  // the Kana that get an apostrophe after 'n' and the consonants that repeat
+  // for sokuon are compile time sets so make sure they match the Kana data
+  for (auto& i : Kana::getMap(CharType::Hiragana)) {
+    auto& k{*i.second};
+    const String r{k.romaji()}, h{k.hiragana()}, kata{k.katakana()};
+    if (r.starts_with("n") || r.starts_with("l")) continue;
+    if (r.size() == 1 || r == "ya" || r == "yu" || r == "yo") {
+      EXPECT_EQ(hiraganaToRomaji("ん" + h), "n'" + r);
+      EXPECT_EQ(katakanaToRomaji("ン" + kata), "n'" + r);
+    } else {
+      const String sokuon{k.getSokuonRomaji(ConvertFlags::None)};
+      EXPECT_EQ(hiraganaToRomaji("っ" + h), sokuon);
+      EXPECT_EQ(katakanaToRomaji("ッ" + kata), sokuon);
+      EXPECT_EQ(romajiToHiragana(sokuon), "っ" + h) << sokuon;
+    }
+  }
+}
+
 TEST_F(ConverterTest, ConvertBetweenKana) {
   for (auto& i : Kana::getMap(CharType::Hiragana)) {
-    const auto r{
-        converter().convert(CharType::Hiragana, i.first, CharType::Katakana)};
+    const auto r{converter().convert(
+        CharType::Hiragana, String{i.first}, CharType::Katakana)};
     EXPECT_EQ(r, i.second->katakana());
     EXPECT_EQ(converter().convert(CharType::Katakana, r, CharType::Hiragana),
         i.second->hiragana());
   }
   for (auto& i : Kana::getMap(CharType::Katakana)) {
-    const auto r{
-        converter().convert(CharType::Katakana, i.first, CharType::Hiragana)};
+    const auto r{converter().convert(
+        CharType::Katakana, String{i.first}, CharType::Hiragana)};
     EXPECT_EQ(r, i.second->hiragana());
     EXPECT_EQ(converter().convert(CharType::Hiragana, r, CharType::Katakana),
         i.second->katakana());
@@ -295,6 +334,43 @@ TEST_F(ConverterTest, ConvertBetweenKana) {
   kanaConvertCheck("じょん・どー", "ジョン・ドー");
 }
 
+TEST_F(ConverterTest, ConvertBetweenKanaMatchesConvertAll) {
+  // converting between Kana uses a fast path (shifting Unicode values) so
+  // compare with converting everything (only Kana source ever changes here
+  // since there's no Ascii or macrons)
+  const std::array parts{"あ", "ん", "っ", "き", "へ", "ゃ", "ぃ", "ゔ", "ゕ",
+      "ゝ", "ゞ", "ゟ", "ア", "ン", "ッ", "キ", "ヘ", "ャ", "ィ", "ヴ", "ヶ",
+      "ヽ", "ヾ", "ヷ", "ヺ", "ー", "・", "。", "漢", "は\xe3\x82\x99",
+      "ハ\xe3\x82\x9a",
+      "き\xef\xb8\x80", "\xe3\x81", "\xe3\x82\x99", "\xf0\x9f\x98\x80"};
+  std::mt19937 gen{11}; // NOLINT: fixed seed so failures can be reproduced
+  std::uniform_int_distribution<size_t> part{0, parts.size() - 1}, len{1, 20};
+  for (auto i{0}; i < 2000; ++i) {
+    String input;
+    for (auto j{len(gen)}; j > 0; --j) input += parts[part(gen)];
+    for (const auto target : {CharType::Hiragana, CharType::Katakana}) {
+      const auto source{target == CharType::Hiragana ? CharType::Katakana
+                                                     : CharType::Hiragana};
+      const auto expected{converter().convert(input, target)};
+      EXPECT_EQ(converter().convert(source, input, target), expected) << input;
+    }
+  }
+  EXPECT_EQ(converter().convert(CharType::Hiragana,
+                "ゔぁいおりん ゝゞ ヽ ー", CharType::Katakana),
+      "ヴァイオリン ヽヾ ヽ ー");
+  EXPECT_EQ(converter().convert(CharType::Katakana,
+                "ヴァイオリン ヷヸヹヺ ヽヾ", CharType::Hiragana),
+      "ゔぁいおりん ヷヸヹヺ ゝゞ");
+  // KanaState only converts the small tsu when it's followed by a Kana and a
+  // small Kana that don't combine (and the fast path gives the same result)
+  EXPECT_EQ(converter().convert(CharType::Katakana, "ッヘャ ヘャ ッキャ",
+                CharType::Hiragana),
+      "っヘャ へゃ っきゃ");
+  EXPECT_EQ(converter().convert(CharType::Hiragana, "っへゃ へゃ っきゃ",
+                CharType::Katakana),
+      "ッへゃ ヘャ ッキャ");
+}
+
 TEST_F(ConverterTest, RepeatSymbol) { // cSpell:disable
   kanaConvertCheck("かゝ", "カヽ", "kaka");
   kanaConvertCheck("かゞ", "カヾ", "kaga");
@@ -502,6 +578,318 @@ TEST_F(ConverterTest, HepburnVersusKunrei) {
   check("ゔ", "ヴ", "vu");
 }
 
+TEST_F(ConverterTest, SinglePassMatchesEachSource) {
+  // cSpell:disable
+  const std::array parts{"a", "n", "N", "ka", "K", "tt", "kya", "ō", "Ā", "'",
+      "-", " ", ".", "!", "あ", "ん", "っ", "き", "ゃ", "ゝ", "ゞ", "ア", "ン",
+      "ッ", "キ", "ャ", "ヽ", "ヾ", "ー", "。", "、", "（", "漢", "ば",
+      "\xe3\x81"}; // cSpell:enable
+  std::mt19937 gen{7}; // NOLINT: fixed seed so failures can be reproduced
+  std::uniform_int_distribution<size_t> part{0, parts.size() - 1}, len{1, 12};
+  for (auto i{0}; i < 2000; ++i) {
+    String input;
+    for (auto j{len(gen)}; j > 0; --j) input += parts[part(gen)];
+    for (const auto target : CharTypes)
+      for (const auto flags : {ConvertFlags::None, ConvertFlags::RemoveSpaces,
+               ConvertFlags::Hepburn | ConvertFlags::NoProlongMark}) {
+        auto expected{input};
+        for (const auto source : CharTypes)
+          if (source != target)
+            expected = converter().convert(source, expected, target, flags);
+        EXPECT_EQ(converter().convert(input, target, flags), expected)
+            << input << " to " << toString(target);
+      }
+  }
+}
+
+TEST_F(ConverterTest, StreamChunks) {
+  // cSpell:disable
+  const String input{"kon'nichiha, tōkyō desu ne. kippu kan'i n\n"
+                     "ニンジャ samurai-san はー\xe3\x82\x99 き\xef\xb8\x80"
+                     "かゝ ヽ ちょっと matchi \xe3\x81 tten"}; // cSpell:enable
+  for (const auto target : CharTypes) {
+    converter().target(target);
+    for (const auto all : {true, false}) {
+      const auto expected{all ? converter().convert(input)
+                              : converter().convert(CharType::Romaji, input)};
+      for (size_t size{1}; size <= input.size(); ++size) {
+        String out;
+        auto s{all ? ConverterStream{converter()}
+                   : ConverterStream{converter(), CharType::Romaji}};
+        for (size_t i{}; i < input.size(); i += size)
+          s.feed(StringView{input}.substr(i, size), out);
+        s.finish(out);
+        EXPECT_EQ(out, expected) << "chunk size " << size;
+      }
+      // also check converting from an istream
+      std::stringstream in{input}, os;
+      if (all)
+        ConverterStream{converter()}.convert(in, os, 3);
+      else
+        ConverterStream{converter(), CharType::Romaji}.convert(in, os, 3);
+      EXPECT_EQ(os.str(), expected);
+    }
+  }
+}
+
+TEST_F(ConverterTest, StreamInvalidBytesAtChunkBoundaries) {
+  // stray continuation bytes shouldn't cause a complete character before them
+  // to be split (or dropped) no matter where the chunks are split
+  const std::array inputs{"ー\xb8\xb8", "か\xb8\xb8" "a", "ゝカ\xb8\x80",
+      "ka\x80\x80\x80\x80\x80", "\x80\x80き\xb8\xb8\xb8\xb8\xb8ゝ",
+      "キ\xb8\xef\xb8\x80ー", "か\xb8\xe3\x82\x99\xb8\xb8"};
+  for (const String input : inputs)
+    for (const auto target : CharTypes) {
+      converter().target(target);
+      for (const auto all : {true, false})
+        for (const auto source : CharTypes) {
+          if (all && source != CharType::Hiragana) continue;
+          const auto expected{all ? converter().convert(input)
+                                  : converter().convert(source, input)};
+          for (size_t split{}; split <= input.size(); ++split) {
+            String out;
+            auto s{all ? ConverterStream{converter()}
+                       : ConverterStream{converter(), source}};
+            s.feed(StringView{input}.substr(0, split), out);
+            s.feed(StringView{input}.substr(split), out);
+            s.finish(out);
+            EXPECT_EQ(out, expected)
+                << input << " split at " << split << " to "
+                << toString(target) << (all ? "" : " from " + toString(source));
+          }
+        }
+    }
+}
+
+TEST_F(ConverterTest, SplitPoints) {
+  using V = std::vector<size_t>;
+  EXPECT_EQ(ConverterStream::splitPoints("ab\ncd ef", 1), (V{3, 6}));
+  EXPECT_EQ(ConverterStream::splitPoints("ab\ncd ef", 4), V{6});
+  EXPECT_EQ(ConverterStream::splitPoints("ab\ncd ef", 7), V{});
+  // must be followed by an Ascii character
+  EXPECT_EQ(ConverterStream::splitPoints("か\nき", 1), V{});
+  // iteration mark can't come before Kana of the same type
+  EXPECT_EQ(ConverterStream::splitPoints("か\n ゝ", 1), V{});
+  EXPECT_EQ(ConverterStream::splitPoints("か\n ゝ.a", 1), V{9});
+  EXPECT_EQ(ConverterStream::splitPoints("か\n アゝ", 1), V{});
+  EXPECT_EQ(ConverterStream::splitPoints("か\n きゝ", 1), V{4});
+  EXPECT_EQ(ConverterStream::splitPoints("カ\n あヽ", 1), V{});
+  // ok if there are no previous Kana of the same type
+  EXPECT_EQ(ConverterStream::splitPoints("か\n ヽ", 1), V{4});
+  EXPECT_EQ(ConverterStream::splitPoints("ア\n ゝ", 1), V{4});
+  EXPECT_EQ(ConverterStream::splitPoints("カ\n あキヽ", 1), V{4});
+  // only return a position once it's safe if more input can follow
+  EXPECT_EQ(ConverterStream::splitPoints("かカ\n き", 1, false), V{});
+  EXPECT_EQ(ConverterStream::splitPoints("かカ\n きキ", 1, false), V{7});
+}
+
+TEST_F(ConverterTest, SplitPartsMatchConvert) {
+  // cSpell:disable
+  const std::array parts{"a", "n", "ka", "tt", "kya", "ō", "'", "-", " ",
+      "\n", ".", "1", "あ", "ん", "っ", "き", "ゃ", "ゝ", "ゞ", "ア", "ン",
+      "ッ", "キ", "ヽ", "ヾ", "ー", "。", "漢", "ば", "\xe3\x82\x99",
+      "\xef\xb8\x80", "\xe3\x81"}; // cSpell:enable
+  std::mt19937 gen{13}; // NOLINT: fixed seed so failures can be reproduced
+  std::uniform_int_distribution<size_t> part{0, parts.size() - 1}, len{1, 40};
+  for (auto i{0}; i < 500; ++i) {
+    String input;
+    for (auto j{len(gen)}; j > 0; --j) input += parts[part(gen)];
+    for (const auto target : CharTypes) {
+      converter().target(target);
+      const auto expected{converter().convert(input)};
+      for (const size_t partSize : {1, 5}) {
+        String out;
+        size_t prev{};
+        auto points{ConverterStream::splitPoints(input, partSize)};
+        points.emplace_back(input.size());
+        for (const auto j : points) {
+          ConverterStream{converter()}.finish(
+              StringView{input}.substr(prev, j - prev), out);
+          prev = j;
+        }
+        EXPECT_EQ(out, expected) << input << " to " << toString(target);
+      }
+    }
+  }
+}
+
+TEST_F(ConverterTest, ConvertKana) {
+  String out; // cSpell:disable
+  convertKana("akaチャン", CharType::Romaji, CharType::Hiragana,
+      ConvertFlags::None, out);
+  EXPECT_EQ(out, "あかチャン");
+  convertKana(
+      " akaチャン", CharType::Hiragana, ConvertFlags::RemoveSpaces, out);
+  EXPECT_EQ(out, "あかチャンあかちゃん"); // cSpell:enable
+}
+
+TEST_F(ConverterTest, ConvertKanaConcurrently) {
+  // cSpell:disable
+  const std::array inputs{"kon'nichiha, tōkyō desu ne. kippu kan'i",
+      "ニンジャ ちょっと まっち ーかゝ き\xef\xb8\x80 ば",
+      "matchi tchi sha shi chi tsu fu ji di du", "ヴァ ヷ ゔぁ kyā ryū"};
+  // cSpell:enable
+  const std::array flagList{ConvertFlags::None, ConvertFlags::Hepburn,
+      ConvertFlags::Kunrei | ConvertFlags::NoProlongMark};
+  // get expected results using a single thread
+  std::vector<String> expected;
+  for (auto& input : inputs)
+    for (const auto target : CharTypes)
+      for (const auto flags : flagList)
+        expected.emplace_back(converter().convert(input, target, flags));
+  // each thread converts all combinations (starting at a different position)
+  // many times so different targets and flags are being used at the same time
+  static constexpr size_t Threads{8}, Loops{200};
+  std::vector<std::future<size_t>> results;
+  for (size_t t{}; t < Threads; ++t)
+    results.emplace_back(std::async(std::launch::async, [&, t] {
+      size_t errors{};
+      String out;
+      for (size_t i{}; i < Loops * expected.size(); ++i) {
+        const auto j{(i + t) % expected.size()};
+        const auto flags{flagList[j % flagList.size()]};
+        const auto target{CharTypes[j / flagList.size() % CharTypes.size()]};
+        out.clear();
+        convertKana(inputs[j / flagList.size() / CharTypes.size()], target,
+            flags, out);
+        if (out != expected[j]) ++errors;
+      }
+      return errors;
+    }));
+  for (auto& i : results) EXPECT_EQ(i.get(), 0);
+}
+
+TEST_F(ConverterTest, RomajiInput) {
+  RomajiInput in;
+  const auto push{[&in](char c) {
+    const auto change{in.push(c)};
+    return String{change.erased} + '|' + String{change.inserted};
+  }};
+  EXPECT_EQ(push('k'), "|k");
+  EXPECT_EQ(push('y'), "|y");
+  EXPECT_EQ(in.pending(), "ky");
+  EXPECT_EQ(push('a'), "ky|きゃ");
+  EXPECT_EQ(in.committed(), "きゃ");
+  EXPECT_EQ(push('n'), "|n");
+  EXPECT_EQ(push('n'), "n|んn"); // second 'n' could start 'na', 'ni', etc.
+  EXPECT_EQ(in.text(), "きゃんn");
+  EXPECT_EQ(push('a'), "n|な");
+  EXPECT_EQ(push('t'), "|t");
+  EXPECT_EQ(push('t'), "|t");
+  EXPECT_EQ(push('e'), "tt|って");
+  EXPECT_EQ(push(' '), "|　");
+  EXPECT_EQ(in.text(), "きゃんなって　");
+  in.clear();
+  EXPECT_EQ(in.text(), "");
+}
+
+TEST_F(ConverterTest, RomajiInputBackspace) {
+  RomajiInput in{CharType::Katakana};
+  for (const auto c : StringView{"kyak"}) in.push(c);
+  EXPECT_EQ(in.text(), "キャk");
+  auto change{in.backspace()};
+  EXPECT_EQ(change.erased, "k");
+  EXPECT_EQ(change.inserted, "");
+  EXPECT_EQ(in.backspace().erased, "ャ"); // removes one converted character
+  EXPECT_EQ(in.text(), "キ");
+  EXPECT_EQ(in.push('e').inserted, "エ");
+  EXPECT_EQ(in.backspace().erased, "エ");
+  EXPECT_EQ(in.backspace().erased, "キ");
+  EXPECT_EQ(in.backspace().erased, ""); // nothing left to delete
+  // bytes of an incomplete multi-byte value are dropped
+  in.push('\xc5');
+  EXPECT_EQ(in.backspace().erased, "");
+  EXPECT_EQ(in.push('a').inserted, "ア");
+}
+
+TEST_F(ConverterTest, RomajiInputMultiByte) {
+  RomajiInput in;
+  in.push('t');
+  const String macron{"ō"};
+  EXPECT_EQ(in.push(macron[0]).inserted, ""); // wait for the next byte
+  const auto change{in.push(macron[1])};
+  EXPECT_EQ(change.erased, "t");
+  EXPECT_EQ(change.inserted, "とー");
+  EXPECT_EQ(in.text(), "とー");
+}
+
+TEST_F(ConverterTest, RomajiInputFlushMatchesConvert) {
+  // cSpell:disable
+  const std::array parts{"a", "n", "N", "ka", "K", "tt", "kya", "ō", "'", "-",
+      " ", ".", "!", "\n", "x", "q", "あ", "\xe3\x81"}; // cSpell:enable
+  std::mt19937 gen{17}; // NOLINT: fixed seed so failures can be reproduced
+  std::uniform_int_distribution<size_t> part{0, parts.size() - 1}, len{1, 12};
+  for (auto i{0}; i < 1000; ++i) {
+    String input;
+    for (auto j{len(gen)}; j > 0; --j) input += parts[part(gen)];
+    for (const auto target : {CharType::Hiragana, CharType::Katakana}) {
+      RomajiInput in{target, ConvertFlags::RemoveSpaces};
+      String shown; // apply each Change to make sure they match 'text'
+      const auto apply{[&shown](RomajiInput::Change c) {
+        ASSERT_TRUE(shown.ends_with(c.erased));
+        shown.resize(shown.size() - c.erased.size());
+        shown += c.inserted;
+      }};
+      for (const auto c : input) apply(in.push(c));
+      apply(in.flush());
+      EXPECT_EQ(shown, in.text());
+      EXPECT_EQ(in.text(), converter().convert(CharType::Romaji, input, target,
+                               ConvertFlags::RemoveSpaces))
+          << input;
+    }
+  }
+}
+
+TEST_F(ConverterTest, RomajiInputTarget) {
+  EXPECT_EQ(RomajiInput{CharType::Katakana}.target(), CharType::Katakana);
+  const auto f{[] { RomajiInput{CharType::Romaji}; }};
+  EXPECT_THROW(call(f, "RomajiInput target must be Hiragana or Katakana"),
+      DomainError);
+}
+
+TEST_F(ConverterTest, ConvertForms) {
+  KanaForms forms; // cSpell:disable
+  converter().convertForms(CharType::Romaji, "kyōto ニンジャ", forms);
+  EXPECT_EQ(forms.hiragana, "きょーと　ニンジャ");
+  EXPECT_EQ(forms.katakana, "キョート　ニンジャ");
+  EXPECT_EQ(forms.romaji, "kyōto ニンジャ");
+  forms.clear();
+  converter().convertForms(CharType::Katakana, "ニンジャ", forms);
+  EXPECT_EQ(forms[CharType::Hiragana], "にんじゃ");
+  EXPECT_EQ(forms[CharType::Katakana], "ニンジャ");
+  EXPECT_EQ(forms[CharType::Romaji], "ninja"); // cSpell:enable
+}
+
+TEST_F(ConverterTest, ConvertFormsMatchesConvert) {
+  // cSpell:disable
+  const std::array parts{"a", "n", "N", "ka", "tt", "kya", "ō", "'", "-", " ",
+      ".", "あ", "ん", "っ", "き", "ゃ", "ゝ", "ア", "ン", "ッ", "キ", "ャ",
+      "ヽ", "ー", "。", "漢", "\xe3\x82\x99", "\xe3\x81"}; // cSpell:enable
+  std::mt19937 gen{19}; // NOLINT: fixed seed so failures can be reproduced
+  std::uniform_int_distribution<size_t> part{0, parts.size() - 1}, len{1, 12};
+  KanaForms forms;
+  for (auto i{0}; i < 1000; ++i) {
+    String input;
+    for (auto j{len(gen)}; j > 0; --j) input += parts[part(gen)];
+    for (const auto flags : {ConvertFlags::None,
+             ConvertFlags::Kunrei | ConvertFlags::NoProlongMark |
+                 ConvertFlags::RemoveSpaces}) {
+      converter().flags(flags);
+      for (const auto source : CharTypes) {
+        forms.clear();
+        converter().convertForms(source, input, forms);
+        for (const auto target : CharTypes) {
+          String expected;
+          convertKana(input, source, target, flags, expected);
+          EXPECT_EQ(forms[target], expected)
+              << input << " from " << toString(source) << " to "
+              << toString(target);
+        }
+      }
+    }
+  }
+}
+
 TEST_F(ConverterTest, CheckDelims) {
   using P = std::pair<char, const char*>;
   for (const auto& i : {P{' ', "　"}, P{'.', "。"}, P{',', "、"}, P{':', "："},
@@ -14,8 +14,18 @@ TEST(DisplaySizeTest, WideBlocksRange) {
   }
 }
 
+TEST(DisplaySizeTest, WideCodesTable) {
+  // table should give the same results as searching 'WideBlocks'
+  for (Code c{}; c <= MaxUnicode; ++c)
+    ASSERT_EQ(isWideDisplay(c), inRange(c, WideBlocks)) << toUnicode(c);
+  static_assert(isWideDisplay(U'カ') && !isWideDisplay(U'ｶ'));
+  static_assert(displaySize(U'a') == 1 && displaySize(U'𠮟') == 2);
+  static_assert(displaySize(U'\0') == 0 && displaySize(U'\xfe01') == 0);
+}
+
 TEST(DisplaySizeTest, DisplaySize) {
   EXPECT_EQ(displaySize(""), 0);
+  EXPECT_EQ(displaySize(static_cast<const char*>(nullptr)), 0);
   EXPECT_EQ(displaySize("abc ."), 5);
   EXPECT_EQ(displaySize(emptyString()), 0);
   EXPECT_EQ(displaySize(String{"abc ."}), 5);
@@ -33,6 +43,9 @@ TEST(DisplaySizeTest, DisplaySize) {
   EXPECT_EQ(displaySize(s), 4);
   // try a character beyond BMP
   EXPECT_EQ(displaySize("𠮟"), 2);
+  // long Ascii runs mixed with wide chars and invalid UTF-8 (narrow)
+  const String ascii(40, 'a');
+  EXPECT_EQ(displaySize(ascii + "犬" + ascii + "\x80" + ascii), 123);
 }
 
 TEST(DisplaySizeTest, U32DisplaySize) {
@@ -48,11 +48,24 @@ private:
 TEST_F(KanaConvertTest, Usage) {
   const char* args[]{"", "-?"};
   run(args,
-      R"(usage: kanaConvert -i
-       kanaConvert [-n] string ...
+      R"(usage: kanaConvert [-a] -i
+       kanaConvert -l
+       kanaConvert [-a] [-n] string ...
+       kanaConvert [-j jobs] -F file ...
        kanaConvert -m|-p|-?
+  -a: print all forms (Hiragana, Katakana and Rōmaji separated by tabs) for
+     each string or line of input instead of converting to one target
   -i: interactive mode
+  -l: live interactive mode, Rōmaji is converted to Kana as keys are typed
+     (Backspace deletes, Enter starts a new line and Ctrl-D quits)
   -n: suppress newline on output (for non-interactive mode)
+  -F file: convert contents of 'file' (streamed so it can be any size), can be
+     used multiple times to convert files one after another
+  -j jobs: batch mode, split '-F' files at safe boundaries and convert up to
+     'jobs' parts in parallel (output order is preserved), throughput for each
+     file is reported to stderr. Boundaries are newlines, spaces and Ascii
+     punctuation so long stretches without any (like a very long line of
+     Kana) are converted on one thread
   -m: print Kana chart in 'Markdown' format and exit
   -p: print Kana chart aligned for terminal output and exit
   -?: prints this usage message
@@ -76,9 +89,9 @@ related flags can also be specified:
 }
 
 TEST_F(KanaConvertTest, IllegalOption) {
-  const char* args[]{"", "-a"};
+  const char* args[]{"", "-b"};
   const auto f{[&args] { KanaConvert{args}; }};
-  EXPECT_THROW(call(f, "illegal option: -a"), DomainError);
+  EXPECT_THROW(call(f, "illegal option: -b"), DomainError);
 }
 
 TEST_F(KanaConvertTest, MissingFlagOption) {
@@ -96,24 +109,73 @@ TEST_F(KanaConvertTest, IllegalFlagOption) {
 }
 
 TEST_F(KanaConvertTest, MultipleProgramModes) {
-  for (const auto i : {"-i", "-m", "-n", "-p"}) {
+  for (const auto i : {"-i", "-l", "-m", "-n", "-p"}) {
     const char* args[]{"", "-i", i};
     const auto f{[&args] { KanaConvert{args}; }};
     EXPECT_THROW(
-        call(f, "can only specify one of -i, -m, -n, or -p"), DomainError);
+        call(f, "can only specify one of -i, -l, -m, -n, or -p"), DomainError);
   }
 }
 
 TEST_F(KanaConvertTest, InteractiveOrPrintOptionsAndStrings) {
-  for (const auto i : {"-i", "-m", "-p"}) {
+  for (const auto i : {"-i", "-l", "-m", "-p"}) {
     const char* args[]{"", i, "hi"};
     const auto f{[&args] { KanaConvert{args}; }};
     EXPECT_THROW(
-        call(f, "'string' args can't be combined with '-i', '-m' or '-p'"),
+        call(f,
+            "'string' args can't be combined with '-i', '-l', '-m' or '-p'"),
         DomainError);
   }
 }
 
+TEST_F(KanaConvertTest, MissingFileName) {
+  const char* args[]{"", "-F"};
+  const auto f{[&args] { KanaConvert{args}; }};
+  EXPECT_THROW(call(f, "-F must be followed by a file name"), DomainError);
+}
+
+TEST_F(KanaConvertTest, FileAndStrings) {
+  for (const auto i : {"-i", "-l", "-p", "hi"}) {
+    const char* args[]{"", "-F", "file", i};
+    const auto f{[&args] { KanaConvert{args}; }};
+    EXPECT_THROW(call(f, "'-F' can't be combined with 'string' args, '-i', "
+                         "'-l', '-m' or '-p'"),
+        DomainError);
+  }
+}
+
+TEST_F(KanaConvertTest, MissingFile) {
+  const char* args[]{"", "-F", "missingFile"};
+  const auto f{[&args] { KanaConvert{args}; }};
+  EXPECT_THROW(call(f, "can't open file: missingFile"), DomainError);
+}
+
+TEST_F(KanaConvertTest, MissingJobs) {
+  const char* args[]{"", "-F", "file", "-j"};
+  const auto f{[&args] { KanaConvert{args}; }};
+  EXPECT_THROW(call(f, "-j must be followed by number of jobs"), DomainError);
+}
+
+TEST_F(KanaConvertTest, InvalidJobs) {
+  for (const auto i : {"", "a", "-1", "2x", "２"}) {
+    const char* args[]{"", "-F", "file", "-j", i};
+    const auto f{[&args] { KanaConvert{args}; }};
+    EXPECT_THROW(call(f, "invalid value for '-j': " + String{i}), DomainError);
+  }
+  for (const auto i : {"0", "65536"}) {
+    const char* args[]{"", "-F", "file", "-j", i};
+    const auto f{[&args] { KanaConvert{args}; }};
+    EXPECT_THROW(
+        call(f, "value for '-j' must be from 1 to 65535"), DomainError);
+  }
+}
+
+TEST_F(KanaConvertTest, JobsWithoutFile) {
+  const char* args[]{"", "-j", "2", "hi"};
+  const auto f{[&args] { KanaConvert{args}; }};
+  EXPECT_THROW(call(f, "'-j' requires one or more '-F' files"), DomainError);
+}
+
 TEST_F(KanaConvertTest, NoStringsAndNoInteractiveMode) {
   const char* args[]{""};
   const auto f{[&args, this] { KanaConvert{args, os(), &is()}; }};
@@ -250,6 +312,76 @@ TEST_F(KanaConvertTest, ConvertMultipleStringsNoSpace) {
   run(args, "ぜひ\n");
 }
 
+TEST_F(KanaConvertTest, ConvertFile) {
+  const std::filesystem::path file{"kanaConvertTestFile"};
+  std::ofstream{file} << "kon'nichiha\ntōkyō desu\n[sannin]\n";
+  const char* args[]{"", "-F", file.c_str()};
+  run(args, "こんにちは\nとーきょー　です\n「さんにん」\n");
+  std::filesystem::remove(file);
+}
+
+TEST_F(KanaConvertTest, ConvertFileWithOptions) {
+  const std::filesystem::path file{"kanaConvertTestOptionsFile"};
+  std::ofstream{file} << "kon'nichiha\ntōkyō desu\n[sannin]\n";
+  const char* args[]{"", "-k", "-R", "-F", file.c_str()};
+  run(args, "コンニチハ\nトーキョー　デス\n「サンニン」\n");
+  std::filesystem::remove(file);
+}
+
+TEST_F(KanaConvertTest, ConvertMultipleFiles) {
+  const std::filesystem::path f1{"kanaConvertTestFile1"},
+      f2{"kanaConvertTestFile2"};
+  std::ofstream{f1} << "kon'nichiha\n";
+  std::ofstream{f2} << "sayōnara\n";
+  const char* args[]{"", "-F", f1.c_str(), "-F", f2.c_str()};
+  run(args, "こんにちは\nさよーなら\n");
+  std::filesystem::remove(f1);
+  std::filesystem::remove(f2);
+}
+
+TEST_F(KanaConvertTest, ConvertBatch) {
+  const std::filesystem::path path{"kanaConvertTestBatchFile"};
+  {
+    // make a file bigger than one part (and with some iteration marks)
+    std::ofstream f{path};
+    for (auto i{0}; i < 40000; ++i)
+      f << "kon'nichiha. " << i << " かゝ ヽ\n";
+  }
+  const auto file{path.c_str()};
+  for (const auto target : {"-k", "-r"}) {
+    std::stringstream expected, out, err;
+    const char* args[]{"", target, "-F", file};
+    KanaConvert{args, expected, &is()};
+    const char* batch[]{"", target, "-j", "4", "-F", file};
+    KanaConvert{batch, out, &is(), err};
+    EXPECT_EQ(out.str(), expected.str());
+    EXPECT_TRUE(err.str().starts_with(path.string() + ": "));
+    EXPECT_TRUE(err.str().ends_with(" MB/s, jobs=4)\n"));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_F(KanaConvertTest, ConvertBatchWithoutSplitPoints) {
+  const std::filesystem::path path{"kanaConvertTestBatchNoSplitFile"};
+  {
+    // start with a long run that has no split points (no newlines, spaces or
+    // Ascii punctuation) followed by normal lines
+    std::ofstream f{path};
+    for (auto i{0}; i < 50000; ++i) f << "kippuきっぷゝヽカ";
+    for (auto i{0}; i < 10000; ++i) f << "\nkon'nichiha かゝ " << i;
+  }
+  const auto file{path.c_str()};
+  for (const auto target : {"-h", "-r"}) {
+    std::stringstream expected, out, err;
+    const char* args[]{"", target, "-F", file};
+    KanaConvert{args, expected, &is()};
+    const char* batch[]{"", target, "-j", "1", "-F", file};
+    KanaConvert{batch, out, &is(), err};
+    EXPECT_EQ(out.str(), expected.str());
+  }
+  std::filesystem::remove(path);
+}
+
 // Interactive Mode tests
 
 TEST_F(KanaConvertTest, InteractiveConvert) {
@@ -305,4 +437,61 @@ TEST_F(KanaConvertTest, InteractiveIllegalOption) {
       SkipFirstTwoLines);
 }
 
+TEST_F(KanaConvertTest, AllForms) {
+  const char* args[]{"", "-a", "-R", "kyōto", "tokyo"};
+  run(args, "きょーと\tキョート\tkyōto\nときょ\tトキョ\ttokyo\n");
+}
+
+TEST_F(KanaConvertTest, AllFormsWithoutSource) {
+  const char* args[]{"", "-a", "-f", "h", "ninjaニンジャ"};
+  run(args, "にんじゃにんじゃ\tニンジャニンジャ\tninjaninja\n");
+}
+
+TEST_F(KanaConvertTest, AllFormsWithOtherModes) {
+  for (const auto i : {"-F", "-l", "-p"}) {
+    const char* args[]{"", "-a", i, "file"};
+    const auto f{[&args] { KanaConvert{args}; }};
+    EXPECT_THROW(
+        call(f, "'-a' can't be combined with '-F', '-l', '-m' or '-p'"),
+        DomainError);
+  }
+}
+
+TEST_F(KanaConvertTest, InteractiveAllForms) {
+  const char* args[]{"", "-a", "-i", "-K"};
+  is() << "カッパ\n";
+  run(args, "かっぱ\tカッパ\tkappa\n", SkipFirstTwoLines);
+}
+
+// Live Mode tests
+
+TEST_F(KanaConvertTest, LiveMode) {
+  const char* args[]{"", "-l", "-k"};
+  is() << "kya\x04";
+  run(args, ">>> live mode: target=Katakana, flags=None\n"
+            ">>> type Rōmaji (Backspace=delete, Enter=new line, "
+            "Ctrl-D=quit):\nky\b\b  \b\bキャ\n");
+}
+
+TEST_F(KanaConvertTest, LiveModeBackspaceAndEnter) {
+  const char* args[]{"", "-l"};
+  // Backspace removes the whole width of a wide char (or does nothing if there
+  // is no text) and Enter converts a final 'n' (Ctrl-D also ends a line)
+  is() << "ka\x7fki\b\bkon\nx\x04";
+  run(args,
+      "k\b \bか\b\b  \b\bk\b \bき\b\b  \b\bk\b \bこn\b \bん\nx\n",
+      SkipFirstTwoLines);
+}
+
+TEST_F(KanaConvertTest, LiveModeRomajiTarget) {
+  for (const auto i : {"-r", "-H"}) {
+    const char* args[]{"", "-l", i};
+    const auto f{[&args] { KanaConvert{args}; }};
+    EXPECT_THROW(call(f, i == String{"-r"}
+                             ? "'-l' requires Hiragana or Katakana target"
+                             : "'-l' only supports Rōmaji source"),
+        DomainError);
+  }
+}
+
 } // namespace kanji_tools
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <kt_kana/Kana.h>
 #include <kt_kana/Utf8Char.h>
+#include <kt_utils/UnicodeBlock.h>
 
 namespace kanji_tools {
 
@@ -45,7 +46,8 @@ TEST(KanaTest, CheckSmallTsu) {
   EXPECT_FALSE(Kana::SmallTsu.isDigraph());
   EXPECT_FALSE(Kana::SmallTsu.isDakuten());
   EXPECT_FALSE(Kana::SmallTsu.isHanDakuten());
-  EXPECT_EQ(Kana::SmallTsu.romajiVariants(), Kana::RomajiVariants::List{"xtu"});
+  ASSERT_EQ(Kana::SmallTsu.romajiVariants().size(), 1);
+  EXPECT_EQ(Kana::SmallTsu.romajiVariants()[0], "xtu");
   EXPECT_FALSE(Kana::SmallTsu.kunreiVariant());
 }
 
@@ -83,10 +85,8 @@ TEST(KanaTest, RepeatMarkGet) {
 }
 
 TEST(KanaTest, RepeatMarkGetRomaji) {
-  auto& m{Kana::getMap(Romaji)};
-  const auto i{m.find("tsu")};
-  ASSERT_TRUE(i != m.end());
-  auto* prev{i->second};
+  auto* prev{Kana::getMap(Romaji).find("tsu")};
+  ASSERT_TRUE(prev);
   auto flags{ConvertFlags::None};
   EXPECT_EQ(Kana::RepeatPlain.get(Romaji, flags, prev), "tsu");
   EXPECT_EQ(Kana::RepeatAccented.get(Romaji, flags, prev), "du");
@@ -101,6 +101,41 @@ TEST(KanaTest, RepeatMarkGetRomaji) {
   EXPECT_EQ(Kana::RepeatAccented.get(Romaji, flags, prev), "zu");
 }
 
+TEST(KanaTest, RomajiForms) {
+  auto& m{Kana::getMap(Romaji)};
+  auto* chi{m.find("chi")};
+  auto* du{m.find("du")};
+  ASSERT_TRUE(chi && du);
+  using enum ConvertFlags;
+  EXPECT_EQ(chi->getRomaji(None), "chi");
+  EXPECT_EQ(chi->getRomaji(Kunrei), "ti");
+  EXPECT_EQ(chi->getRomaji(Hepburn | Kunrei), "ti");
+  EXPECT_EQ(du->getRomaji(Hepburn), "zu");
+  EXPECT_EQ(du->getRomaji(Kunrei), "zu");
+  // NoProlongMark and RemoveSpaces don't affect Rōmaji
+  EXPECT_EQ(du->getRomaji(NoProlongMark | RemoveSpaces), "du");
+}
+
+TEST(KanaTest, SokuonRomaji) {
+  auto& m{Kana::getMap(Romaji)};
+  auto* chi{m.find("chi")};
+  auto* du{m.find("du")};
+  ASSERT_TRUE(chi && du);
+  using enum ConvertFlags;
+  EXPECT_EQ(chi->getSokuonRomaji(None), "tchi");
+  EXPECT_EQ(chi->getSokuonRomaji(Kunrei), "tti");
+  EXPECT_EQ(du->getSokuonRomaji(None), "ddu");
+  EXPECT_EQ(du->getSokuonRomaji(Hepburn), "zzu");
+  for (auto& i : m)
+    for (size_t form{}; form < Kana::RomajiForms; ++form) {
+      const auto flags{static_cast<ConvertFlags>(form)};
+      const auto r{i.second->getRomaji(flags)};
+      const auto s{i.second->getSokuonRomaji(flags)};
+      ASSERT_EQ(s.size(), r.size() + 1);
+      EXPECT_EQ(s.substr(1), r);
+    }
+}
+
 TEST(KanaTest, FindRepeatMark) {
   EXPECT_EQ(Kana::findIterationMark(Hiragana, "ゝ"), &Kana::RepeatPlain);
   EXPECT_EQ(Kana::findIterationMark(Katakana, "ヽ"), &Kana::RepeatPlain);
@@ -128,6 +163,69 @@ TEST(KanaTest, FindHanDakuten) {
   EXPECT_FALSE(Kana::findHanDakuten("bad"));
 }
 
+TEST(KanaTest, Compose) {
+  EXPECT_EQ(Kana::composeDakuten(U'か'), "が");
+  EXPECT_EQ(Kana::composeDakuten(U'シ'), "ジ");
+  EXPECT_EQ(Kana::composeDakuten(U'う'), "ゔ");
+  EXPECT_EQ(Kana::composeHanDakuten(U'は'), "ぱ");
+  EXPECT_EQ(Kana::composeHanDakuten(U'ホ'), "ポ");
+  for (const auto c : {U'ま', U'マ', U'が', U'ん', U'a', U'\x303f', U'\x3100'})
+    EXPECT_TRUE(Kana::composeDakuten(c).empty()) << toUnicode(c);
+  EXPECT_TRUE(Kana::composeHanDakuten(U'さ').empty());
+  EXPECT_TRUE(Kana::composeHanDakuten(U'ぱ').empty());
+}
+
+TEST(KanaTest, ComposeMatchesFind) {
+  for (auto t : {Hiragana, Katakana})
+    for (auto& i : Kana::getMap(t))
+      if (i.first.size() == Kana::OneKanaSize) {
+        const String s{i.first};
+        const auto c{getCode(s)};
+        EXPECT_EQ(Kana::findDakuten(s).value_or(""), Kana::composeDakuten(c));
+        EXPECT_EQ(
+            Kana::findHanDakuten(s).value_or(""), Kana::composeHanDakuten(c));
+      }
+}
+
+TEST(KanaTest, FindByCode) {
+  for (auto t : {Hiragana, Katakana})
+    for (auto& i : Kana::getMap(t)) {
+      EXPECT_EQ(Kana::find(t, i.first), i.second) << i.first;
+      const auto codes{fromUtf8(String{i.first})};
+      EXPECT_EQ(Kana::find(t, codes[0], codes.size() > 1 ? codes[1] : Code{}),
+          i.second);
+    }
+  EXPECT_EQ(Kana::find(Hiragana, U'き', U'ゃ'), Kana::find(Hiragana, "きゃ"));
+  EXPECT_EQ(Kana::find(Katakana, U'シ', U'ョ')->romaji(), "sho");
+  // Kana from the wrong block, non-small second values and bad input
+  EXPECT_FALSE(Kana::find(Hiragana, U'キ'));
+  EXPECT_FALSE(Kana::find(Katakana, U'き'));
+  EXPECT_FALSE(Kana::find(Hiragana, U'き', U'ャ'));
+  EXPECT_FALSE(Kana::find(Hiragana, U'き', U'や'));
+  EXPECT_FALSE(Kana::find(Hiragana, U'ゟ'));
+  EXPECT_FALSE(Kana::find(Romaji, U'a'));
+  EXPECT_FALSE(Kana::find(Romaji, "ka"));
+  for (const auto s : {"", "a", "abc", "きゃあ", "ゃき", "きa"})
+    EXPECT_FALSE(Kana::find(Hiragana, s)) << s;
+}
+
+TEST(KanaTest, ValidateData) {
+  // Kana objects are built at compile time so check that the values have the
+  // expected types of characters here
+  for (auto& i : Kana::getMap(Hiragana)) {
+    auto& k{*i.second};
+    EXPECT_TRUE(isAllSingleByte(String{k.romaji()})) << k.romaji();
+    for (auto& j : k.romajiVariants())
+      EXPECT_TRUE(isAllSingleByte(String{j})) << j;
+    EXPECT_TRUE(isAllHiragana(String{k.hiragana()})) << k.hiragana();
+    EXPECT_TRUE(isAllKatakana(String{k.katakana()})) << k.katakana();
+  }
+  for (auto i : std::array{&Kana::RepeatPlain, &Kana::RepeatAccented}) {
+    EXPECT_TRUE(isAllHiragana(String{i->hiragana()}));
+    EXPECT_TRUE(isAllKatakana(String{i->katakana()}));
+  }
+}
+
 TEST(KanaTest, CheckHiragana) {
   auto& sourceMap{Kana::getMap(Hiragana)};
   EXPECT_EQ(sourceMap.size(), TotalKana);
@@ -136,7 +234,7 @@ TEST(KanaTest, CheckHiragana) {
       dakutenMonographs{}, plainDigraphs{}, hanDakutenDigraphs{},
       dakutenDigraphs{}, smallDigraphs{};
   for (auto& i : sourceMap) {
-    Utf8Char s{i.first};
+    Utf8Char s{String{i.first}};
     String c;
     const auto checkDigraph{[&i, &c](const String& a, const String& b = {}) {
       EXPECT_TRUE(c == a || (!b.empty() && c == b))
@@ -200,7 +298,7 @@ TEST(KanaTest, CheckKatakana) {
   auto& hiraganaMap{Kana::getMap(Hiragana)};
   EXPECT_EQ(sourceMap.size(), TotalKana);
   for (auto& i : sourceMap) {
-    Utf8Char s{i.first};
+    Utf8Char s{String{i.first}};
     // As long as all entries in katakana map are also be in hiragana map (and
     // the maps are the same size) then there's no need to checkDigraph the
     // various counts again.
@@ -246,7 +344,7 @@ TEST(KanaTest, CheckRomaji) {
     }};
     ASSERT_FALSE(i.first.empty());
     EXPECT_LT(i.first.size(), 4);
-    for (auto& j : i.second->romajiVariants()) romajiVariants.insert(j);
+    for (auto& j : i.second->romajiVariants()) romajiVariants.emplace(j);
     if (i.first == "n")
       ++nNum;
     else
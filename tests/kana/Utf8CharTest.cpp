@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <kt_kana/Kana.h>
 #include <kt_kana/Utf8Char.h>
+#include <kt_utils/UnicodeBlock.h>
 
 namespace kanji_tools {
 
@@ -28,6 +30,18 @@ TEST(Utf8CharTest, Size) {
   EXPECT_EQ(Utf8Char::size(marks), 9);
 }
 
+TEST(Utf8CharTest, SizeOfLongInput) {
+  // long enough to use multiple blocks in the scanning functions plus a tail
+  const String ascii(37, 'a'), marks{"は\xe3\x82\x99"},
+      variant{"逸\xef\xb8\x81"};
+  String s;
+  for (auto i{0}; i < 5; ++i) s += ascii + marks + variant + "\x80" + "𠮟";
+  EXPECT_EQ(Utf8Char::size(s), 15);
+  EXPECT_EQ(Utf8Char::size(s, false), 5 * (37 + 3)); // \x80 isn't counted
+  s += "\xef\xb8"; // truncated variation selector at the end is counted
+  EXPECT_EQ(Utf8Char::size(s), 16);
+}
+
 TEST(Utf8CharTest, GetFirst) {
   EXPECT_EQ(Utf8Char::getFirst(""), "");
   EXPECT_EQ(Utf8Char::getFirst("abc"), "");
@@ -188,6 +202,23 @@ TEST(Utf8CharTest, ErrorWithCombiningMarks) {
   EXPECT_FALSE(s.next(x));
 }
 
+TEST(Utf8CharTest, ClassifyMatchesCombiningMarks) {
+  // classify (in 'utils') should count the same combining marks and errors as
+  // Utf8CharView for every value in the Kana blocks (and a wide space)
+  for (auto c{Kana::CompositionStart}; c <= Kana::CompositionEnd + 1; ++c)
+    for (const auto mark : {CombiningVoiced, CombiningSemiVoiced}) {
+      const auto base{c > Kana::CompositionEnd ? U'　' : c};
+      const auto s{toUtf8(base) + String{mark}};
+      Utf8CharView v{s};
+      for (StringView x; v.next(x);)
+        ;
+      TextCategoryCounts counts;
+      classify(s, counts);
+      EXPECT_EQ(counts[TextCategory::CombiningMarks], v.combiningMarks()) << s;
+      EXPECT_EQ(counts[TextCategory::Errors], v.errors()) << s;
+    }
+}
+
 TEST(Utf8CharTest, Valid) {
   EXPECT_EQ(Utf8Char{""}.valid(), MBUtf8Result::NotMultiByte);
   EXPECT_EQ(Utf8Char{"a"}.valid(), MBUtf8Result::NotMultiByte);
@@ -208,4 +239,51 @@ TEST(Utf8CharTest, Valid) {
   EXPECT_FALSE(Utf8Char{"a猫"}.isValid(false));
 }
 
+TEST(Utf8CharTest, ViewNext) {
+  const auto data{String{"a憎︀む\x80キ"} + String{CombiningVoiced} + 'b'};
+  Utf8CharView s{data};
+  StringView x;
+  EXPECT_TRUE(s.peek(x));
+  EXPECT_EQ(x, "憎︀");
+  EXPECT_TRUE(s.next(x));
+  // results are slices of the original data (including variation selector)
+  EXPECT_EQ(x.data(), data.data() + 1);
+  EXPECT_EQ(x, "憎︀");
+  EXPECT_EQ(s.variants(), 1);
+  EXPECT_TRUE(s.next(x));
+  EXPECT_EQ(x, "む");
+  // combined Kana comes from static Kana strings
+  EXPECT_TRUE(s.peek(x));
+  EXPECT_EQ(x, "ギ");
+  EXPECT_EQ(s.combiningMarks(), 0);
+  EXPECT_EQ(s.errors(), 0);
+  EXPECT_TRUE(s.next(x));
+  EXPECT_EQ(x, "ギ");
+  EXPECT_EQ(x.size(), 3); // precomposed value (not 6 bytes)
+  EXPECT_EQ(s.combiningMarks(), 1);
+  EXPECT_EQ(s.errors(), 1);
+  EXPECT_FALSE(s.next(x));
+  s.reset();
+  EXPECT_EQ(s.errors(), 0);
+  EXPECT_TRUE(s.next(x, false));
+  EXPECT_EQ(x, "a");
+}
+
+TEST(Utf8CharTest, ViewIsNotNullTerminated) {
+  const String data{"猫犬"};
+  // view ends part way through '犬' so it's an error (3 bytes, one for each)
+  Utf8CharView s{StringView{data}.substr(0, 5)};
+  StringView x;
+  EXPECT_TRUE(s.next(x));
+  EXPECT_EQ(x, "猫");
+  EXPECT_FALSE(s.next(x));
+  EXPECT_EQ(s.errors(), 2);
+  // variation selector cut off at the end of the view
+  const String v{"憎︀"};
+  Utf8CharView t{StringView{v}.substr(0, 5)};
+  EXPECT_TRUE(t.next(x));
+  EXPECT_EQ(x, "憎");
+  EXPECT_EQ(t.variants(), 0);
+}
+
 } // namespace kanji_tools
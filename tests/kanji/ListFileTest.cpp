@@ -16,7 +16,8 @@ const fs::path GoodOnePerLine{TestDir / "goodOnePerLine"},
     GoodOnePerLineLevel{TestDir / "goodOnePerLineLevel"},
     MultiplePerLine{TestDir / "multiplePerLine"},
     BadOnePerLine{TestDir / "badOnePerLine"}, BadSymbol{TestDir / "badSymbol"},
-    DuplicateSymbol{TestDir / "duplicateSymbol"}, BigFile{TestDir / "bigFile"};
+    BadUtf8{TestDir / "badUtf8"}, DuplicateSymbol{TestDir / "duplicateSymbol"},
+    BigFile{TestDir / "bigFile"};
 
 class ListFileTest : public ::testing::Test {
 protected:
@@ -27,6 +28,7 @@ protected:
         std::pair{GoodOnePerLineLevel, "犬\n猫\n虎"},
         std::pair{BadOnePerLine, "焼 肉"},
         std::pair{MultiplePerLine, "東 西 線"}, std::pair{BadSymbol, "a"},
+        std::pair{BadUtf8, "東\n西 \xe7\x8a"},
         std::pair{DuplicateSymbol, "車\n車"}};
     for (auto& i : files) {
       std::ofstream of{i.first};
@@ -156,6 +158,13 @@ TEST_F(ListFileTest, BadSymbol) {
       DomainError);
 }
 
+TEST_F(ListFileTest, BadUtf8) {
+  const auto f{[] { ListFile{BadUtf8, ListFile::FileType::MultiplePerLine}; }};
+  EXPECT_THROW(
+      call(f, "invalid UTF-8 at byte 4 - line: 2, file: testDir/badUtf8"),
+      DomainError);
+}
+
 TEST_F(ListFileTest, DuplicateSymbol) {
   EXPECT_THROW(
       call([] { ListFile{DuplicateSymbol}; },
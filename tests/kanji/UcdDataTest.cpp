@@ -4,6 +4,8 @@
 #include <kt_tests/TestUcd.h>
 #include <kt_tests/WhatMismatch.h>
 
+#include <future>
+
 namespace kanji_tools {
 
 namespace {
@@ -155,6 +157,22 @@ TEST_F(UcdDataTest, GetReadingAsKanaForEntryWithNoReadings) {
   EXPECT_EQ(ucd().getReadingsAsKana(&u), "");
 }
 
+TEST_F(UcdDataTest, GetReadingAsKanaConcurrently) {
+  auto& u{loadOne()};
+  const auto& data{ucd()};
+  const String expected{"イチ、イツ、ひとつ、ひとたび、はじめ"};
+  static constexpr size_t Threads{8}, Loops{1000};
+  std::vector<std::future<size_t>> results;
+  for (size_t t{}; t < Threads; ++t)
+    results.emplace_back(std::async(std::launch::async, [&data, &u, &expected] {
+      size_t errors{};
+      for (size_t i{}; i < Loops; ++i)
+        if (data.getReadingsAsKana(&u) != expected) ++errors;
+      return errors;
+    }));
+  for (auto& i : results) EXPECT_EQ(i.get(), 0);
+}
+
 TEST_F(UcdDataTest, NotFound) {
   loadOne();
   EXPECT_EQ(ucd().find("虎"), nullptr);
@@ -152,6 +152,28 @@ TEST_F(ColumnFileTest, GetMultipleRows) {
   EXPECT_EQ(f.currentRow(), 2);
 }
 
+TEST_F(ColumnFileTest, GetView) {
+  auto f{write({Col1, Col2}, "Col1\tCol2\nR11\t\nR21\tR22")};
+  ASSERT_TRUE(f.nextRow());
+  const auto r11{f.getView(Col1)};
+  EXPECT_EQ(r11, "R11");
+  EXPECT_EQ(f.getView(Col2), "");
+  auto& s{f.get(Col1)};
+  EXPECT_EQ(&s, &f.get(Col1)); // same reference for the rest of the row
+  ASSERT_TRUE(f.nextRow());
+  EXPECT_EQ(f.getView(Col1), "R21");
+  EXPECT_EQ(f.get(Col2), "R22");
+  EXPECT_EQ(r11, "R11"); // views stay valid after moving to other rows
+  EXPECT_FALSE(f.nextRow());
+}
+
+TEST_F(ColumnFileTest, GetViewBeforeNextRowError) {
+  const auto f{write({Col}, "Col")};
+  EXPECT_THROW(call([&f] { return f.getView(Col); },
+                   "'nextRow' must be called before calling 'get'" + FileMsg),
+      DomainError);
+}
+
 TEST_F(ColumnFileTest, NotEnoughColumns) {
   auto f{write({Col1, Col2, Col3}, "Col1\tCol2\tCol3\nVal1\tVal2")};
   EXPECT_THROW(
@@ -159,6 +181,18 @@ TEST_F(ColumnFileTest, NotEnoughColumns) {
       DomainError);
 }
 
+TEST_F(ColumnFileTest, InvalidUtf8) {
+  // the whole file is validated by the ctor (before reading any rows)
+  const auto f{[] { write({Col1, Col2}, "Col1\tCol2\n犬\t猫\n犬\t\xe7\x8a"); }};
+  EXPECT_THROW(call(f, "invalid UTF-8 at byte 4" + FileMsg + ", row: 2"),
+      DomainError);
+}
+
+TEST_F(ColumnFileTest, InvalidUtf8InHeaderRow) {
+  const auto f{[] { write({Col1, Col2}, "Col1\tCol2\x80\n犬\t猫"); }};
+  EXPECT_THROW(call(f, "invalid UTF-8 at byte 9" + FileMsg), DomainError);
+}
+
 TEST_F(ColumnFileTest, TooManyColumns) {
   auto f{write({Col1, Col2, Col3}, "Col1\tCol2\tCol3\nVal1\tVal2\tVal3\tVal4")};
   EXPECT_THROW(
@@ -208,6 +242,15 @@ TEST_F(ColumnFileTest, NotRegularFileError) {
   EXPECT_THROW(call(f, "not regular file - file: testDir"), DomainError);
 }
 
+TEST_F(ColumnFileTest, UnreadableFileError) {
+  write("Col");
+  fs::permissions(TestFile, fs::perms::none);
+  // permissions aren't checked for some users (like 'root')
+  if (std::ifstream{TestFile}) GTEST_SKIP() << "file is still readable";
+  EXPECT_THROW(call([] { create({Col}); }, "Permission denied" + FileMsg),
+      DomainError);
+}
+
 TEST_F(ColumnFileTest, MissingHeaderRowError) {
   EXPECT_THROW(
       call([] { write({Col}, "", false); }, "missing header row" + FileMsg),
@@ -255,6 +298,30 @@ TEST_F(ColumnFileTest, GetU64Error) {
       DomainError);
 }
 
+TEST_F(ColumnFileTest, GetU64Max) {
+  auto f{write({Col}, "Col\n18446744073709551615")};
+  EXPECT_TRUE(f.nextRow());
+  EXPECT_EQ(f.getU64(Col), std::numeric_limits<uint64_t>::max());
+}
+
+TEST_F(ColumnFileTest, GetU64InvalidValues) {
+  // values must only have digits (no spaces, signs or trailing characters)
+  // and must fit in 'uint64_t'
+  const std::array values{"12abc", " 12", "12 ", "+12", "-1", "0x12",
+      "18446744073709551616", "99999999999999999999999"};
+  String file{"Col"};
+  for (auto& i : values) (file += '\n') += i;
+  auto f{write({Col}, file)};
+  for (size_t row{1}; auto& i : values) {
+    EXPECT_TRUE(f.nextRow());
+    EXPECT_THROW(call([&] { f.getU64(Col); },
+                     ConvertError + "unsigned number" + FileMsg + ", row: " +
+                         std::to_string(row++) + ", column: 'Col', value: '" +
+                         i + "'"),
+        DomainError);
+  }
+}
+
 TEST_F(ColumnFileTest, GetU64MaxValueError) {
   const auto maxValue{123U};
   std::ofstream of{TestFile};
@@ -353,6 +420,17 @@ TEST_F(ColumnFileTest, GetWChar) {
   EXPECT_EQ(f.getChar32(c2), 134047);
 }
 
+TEST_F(ColumnFileTest, GetWCharFromString) {
+  auto f{write({Col}, "Col\n0")};
+  EXPECT_TRUE(f.nextRow());
+  EXPECT_EQ(f.getChar32(Col, "3042"), U'あ');
+  EXPECT_EQ(f.getChar32(Col, "2A6D6"), U'\U0002A6D6');
+  EXPECT_THROW(call([&] { f.getChar32(Col, "304"); },
+                   ConvertError + "Code, size must be 4 or 5" + FileMsg +
+                       ", row: 1, column: 'Col', value: '304'"),
+      DomainError);
+}
+
 TEST_F(ColumnFileTest, GetWCharError) {
   auto f{write({Col}, "Col\nAAA\n123456\nABCd\nDEFG")};
   const auto _ = {
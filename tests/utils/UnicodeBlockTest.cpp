@@ -64,6 +64,67 @@ TEST(UnicodeBlockTest, CheckKanjiBlocks) {
   EXPECT_EQ(NonSpacingBlocks[0].range(), 16);
 }
 
+TEST(UnicodeBlockTest, CategoryTable) {
+  using enum UnicodeCategory;
+  // table should give the same results as checking the block arrays
+  for (Code c{}; c <= MaxUnicode; ++c) {
+    auto expected{None};
+    if (inRange(c, HiraganaBlocks)) expected |= Hiragana;
+    if (inRange(c, KatakanaBlocks)) expected |= Katakana;
+    if (inRange(c, CommonKanjiBlocks)) expected |= CommonKanji;
+    if (inRange(c, RareKanjiBlocks)) expected |= RareKanji;
+    if (inRange(c, PunctuationBlocks)) expected |= Punctuation;
+    if (inRange(c, SymbolBlocks)) expected |= Symbol;
+    if (inRange(c, LetterBlocks)) expected |= Letter;
+    if (inRange(c, NonSpacingBlocks) || c == CombiningVoicedChar ||
+        c == CombiningSemiVoicedChar)
+      expected |= NonSpacing;
+    ASSERT_EQ(getCategory(c), expected) << toUnicode(c);
+  }
+  static_assert(getCategory(U'あ') == Hiragana);
+  static_assert(getCategory(CombiningVoicedChar) == (Hiragana | NonSpacing));
+  static_assert(getCategory(U'a') == None);
+  static_assert(inCategory(U'𠮟', CommonKanji | RareKanji));
+}
+
+TEST(UnicodeBlockTest, IsCode) {
+  static_assert(isHiragana(U'ゑ') && !isKatakana(U'ゑ') && isKana(U'ゑ'));
+  static_assert(isKatakana(U'ヰ') && !isHiragana(U'ヰ') && isKana(U'ヰ'));
+  static_assert(isCommonKanji(U'𠮟') && !isRareKanji(U'𠮟') && isKanji(U'𠮟'));
+  static_assert(isRareKanji(U'⺠') && !isCommonKanji(U'⺠') && isKanji(U'⺠'));
+  static_assert(isMBSymbol(U'☆') && isMBLetter(U'ｶ') && !isKatakana(U'ｶ'));
+  static_assert(isMBPunctuation(U'。') && !isMBPunctuation(WideSpace));
+  static_assert(isMBPunctuation(WideSpace, true));
+  static_assert(isRecognizedUtf8(WideSpace));
+  static_assert(!isRecognizedUtf8(U'a') && !isKana(U'a'));
+  // results should match the String overloads
+  for (auto& i : {"あ", "ア", "犬", "⺠", "☆", "ｶ", "。", "　", "a"}) {
+    const auto c{getCode(i)};
+    EXPECT_EQ(isKana(c), isKana(i)) << i;
+    EXPECT_EQ(isKanji(c), isKanji(i)) << i;
+    EXPECT_EQ(isMBPunctuation(c), isMBPunctuation(i)) << i;
+    EXPECT_EQ(isMBPunctuation(c, true), isMBPunctuation(i, true)) << i;
+    EXPECT_EQ(isRecognizedUtf8(c), isRecognizedUtf8(i)) << i;
+  }
+}
+
+TEST(UnicodeBlockTest, IsAllCode) {
+  EXPECT_TRUE(isAllHiragana(CodeString{}));
+  // allow one non-spacing value after a Hiragana
+  EXPECT_TRUE(isAllHiragana(CodeString{U"ゑは\x3099あ"}));
+  EXPECT_TRUE(isAllHiragana(CodeString{U"ゑ\xfe00"}));
+  EXPECT_FALSE(isAllHiragana(CodeString{U"ゑ\xfe00\xfe00"}));
+  EXPECT_TRUE(isAllKana(CodeString{U"あア"}));
+  EXPECT_FALSE(isAllKana(CodeString{U"あaア"}));
+  EXPECT_TRUE(isAllKanji(CodeString{U"𫠜𠮟"}));
+  EXPECT_FALSE(isAllCommonKanji(CodeString{U"𫠜𠮟"}));
+  EXPECT_TRUE(isAllMBPunctuation(CodeString{U"　。　、"}));
+  const std::array codes{U'ｶ', U'Ｚ'};
+  EXPECT_TRUE(isAllMBLetter(codes));
+  EXPECT_TRUE(isAllRecognizedUtf8(codes));
+  EXPECT_FALSE(isAllMBSymbol(codes));
+}
+
 TEST(UnicodeBlockTest, IsNonSpacing) {
   CodeString s{U"\x3078\x3099"}; // へ and dakuten combining mark
   EXPECT_EQ(s.size(), 2);
@@ -182,4 +243,55 @@ TEST(UnicodeBlockTest, IsKanji) {
   EXPECT_FALSE(isAllRecognizedUtf8("𫠜馬イxヌねこ"));
 }
 
+TEST(UnicodeBlockTest, Classify) {
+  using enum TextCategory;
+  const String s{"ひらがな カタカナ 漢字⺠𫠜、。「」—☆∀ＡＢｶ①\xe2\x8d\xbe!"};
+  TextCategoryCounts counts;
+  classify(s, counts);
+  EXPECT_EQ(counts[Hiragana], 4);
+  EXPECT_EQ(counts[Katakana], 4);
+  EXPECT_EQ(counts[CommonKanji], 2);
+  EXPECT_EQ(counts[RareKanji], 2);
+  EXPECT_EQ(counts[MBPunctuation], 5);
+  EXPECT_EQ(counts[MBSymbol], 2);
+  EXPECT_EQ(counts[MBLetter], 4);
+  EXPECT_EQ(counts[Unrecognized], 1); // U+237E (from 'Misc Technical' block)
+  EXPECT_EQ(counts[Variants], 0);
+  EXPECT_EQ(counts[CombiningMarks], 0);
+  EXPECT_EQ(counts[Errors], 0);
+}
+
+TEST(UnicodeBlockTest, ClassifyNonSpacingAndErrors) {
+  using enum TextCategory;
+  // 'は' followed by a combining mark and '侮' followed by a variation selector
+  String s{"は"};
+  (s += CombiningVoiced) += "侮\xef\xb8\x80";
+  // 'ホ' followed by a semi-voiced combining mark
+  (s += "ホ") += CombiningSemiVoiced;
+  // wide space isn't counted and combining marks are errors after values they
+  // don't compose with (like Utf8CharView), but a variation selector is ok
+  s += "　";
+  s += CombiningSemiVoiced;
+  (s += "　") += "\xef\xb8\x80";
+  (s += "漢") += CombiningVoiced;
+  (s += "か") += CombiningSemiVoiced;
+  // non-spacing values after a non-spacing value or after Ascii are errors
+  s += CombiningVoiced;
+  (s += 'a') += CombiningVoiced;
+  // invalid UTF-8 is an error, but a real U+FFFD is punctuation ('Specials')
+  s += "\x80\xef\xbf\xbd";
+  TextCategoryCounts counts;
+  classify(s, counts);
+  EXPECT_EQ(counts[Hiragana], 2);
+  EXPECT_EQ(counts[Katakana], 1);
+  EXPECT_EQ(counts[CommonKanji], 2);
+  EXPECT_EQ(counts[MBPunctuation], 1);
+  EXPECT_EQ(counts[CombiningMarks], 2);
+  EXPECT_EQ(counts[Variants], 2);
+  EXPECT_EQ(counts[Errors], 6);
+  // counts are added to
+  classify(String{"犬"}, counts);
+  EXPECT_EQ(counts[CommonKanji], 3);
+}
+
 } // namespace kanji_tools
@@ -129,6 +129,107 @@ TEST(Utf8Test, NotValidForOverlong) {
   EXPECT_EQ(validateUtf8(x), Utf8Result::Overlong);
 }
 
+TEST(Utf8Test, ValidateBuffer) {
+  const auto f{[](const String& s) {
+    return validateUtf8(std::span<const char>{s});
+  }};
+  const auto check{[&f](const String& s, size_t offset, Utf8Result r) {
+    const auto v{f(s)};
+    EXPECT_EQ(v.offset, offset) << s;
+    EXPECT_EQ(v.result, r) << s;
+  }};
+  check("", 0, Utf8Result::Valid);
+  check("abc", 3, Utf8Result::Valid);
+  const String ascii(40, 'a'), mixed{"雪©𒀄" + ascii + "雪"};
+  check(mixed, mixed.size(), Utf8Result::Valid);
+  // errors at the start, middle (after an Ascii block) and end of the input
+  check("\x80" + ascii, 0, Utf8Result::ContinuationByte);
+  check(ascii + SurrogateRangeStart + ascii, 40, Utf8Result::InvalidCodePoint);
+  check(mixed + "\xf0\x82\x82\xac", mixed.size(), Utf8Result::Overlong);
+  check(mixed + toChar(FiveBits) + "\x80\x80\x80", mixed.size(),
+      Utf8Result::CharTooLong);
+  // missing bytes at the end of a buffer that isn't null terminated
+  check(mixed + Dog.substr(0, 2), mixed.size(), Utf8Result::MissingBytes);
+  const std::array bytes{'a', '\xe7', '\x8a', '\xac', 'b', '\xe7', '\x8a'};
+  auto v{validateUtf8(std::span{bytes}.first(5))};
+  EXPECT_EQ(v.offset, 5);
+  EXPECT_EQ(v.result, Utf8Result::Valid);
+  v = validateUtf8(std::span{bytes});
+  EXPECT_EQ(v.offset, 5);
+  EXPECT_EQ(v.result, Utf8Result::MissingBytes);
+  // nulls are allowed (the size of the span is used instead)
+  check(String{"a\0b", 3}, 3, Utf8Result::Valid);
+}
+
+TEST(Utf8Test, ValidateBufferAtEachOffset) {
+  // put valid and invalid sequences at every offset of the first few blocks
+  // (and at the end of the input) to cover sequences that cross blocks
+  const std::array valid{"©", "雪", "𒀄", "\xe0\xa0\x80", "\xed\x9f\xbf",
+      "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf"};
+  const std::array<std::pair<const char*, Utf8Result>, 9> invalid{
+      {{"\x80", Utf8Result::ContinuationByte},
+          {"\xc1\xbf", Utf8Result::Overlong},
+          {"\xe0\x9f\xbf", Utf8Result::Overlong},
+          {"\xed\xa0\x80", Utf8Result::InvalidCodePoint},
+          {"\xf0\x8f\xbf\xbf", Utf8Result::Overlong},
+          {"\xf4\x90\x80\x80", Utf8Result::InvalidCodePoint},
+          {"\xf8\x80\x80\x80", Utf8Result::CharTooLong},
+          {"\xe7\x8a", Utf8Result::MissingBytes},
+          {"\xf0\x9f\x98" "a", Utf8Result::MissingBytes}}};
+  const String suffix(20, 'a');
+  for (const auto& prefix : {String{}, String{"©"}, String{"雪"}})
+    for (size_t i{}; i < 40; ++i) {
+      const auto start{prefix + String(i, 'a')};
+      for (const auto* j : valid)
+        for (const auto& s : {start + j, start + j + suffix}) {
+          const auto v{validateUtf8(std::span<const char>{s})};
+          EXPECT_EQ(v.offset, s.size()) << s;
+          EXPECT_EQ(v.result, Utf8Result::Valid) << s;
+        }
+      for (const auto& [j, r] : invalid)
+        for (const auto& s : {start + j, start + j + suffix}) {
+          const auto v{validateUtf8(std::span<const char>{s})};
+          EXPECT_EQ(v.offset, start.size()) << s;
+          EXPECT_EQ(v.result, r) << s;
+        }
+    }
+}
+
+TEST(Utf8Test, GetMBUtf8Size) {
+  EXPECT_EQ(getMBUtf8Size(""), 0);
+  EXPECT_EQ(getMBUtf8Size("a犬"), 0);
+  EXPECT_EQ(getMBUtf8Size("ã"), 2);
+  EXPECT_EQ(getMBUtf8Size("犬a"), 3);
+  EXPECT_EQ(getMBUtf8Size("𠮟"), 4);
+  EXPECT_EQ(getMBUtf8Size(SurrogateRangeStart), 0);
+  EXPECT_EQ(getMBUtf8Size(StringView{"犬"}.substr(0, 2)), 0);
+  EXPECT_EQ(getMBUtf8Size("\x80"), 0);
+}
+
+TEST(Utf8Test, ScanningFunctions) {
+  // use long input so multiple blocks are scanned (as well as a tail)
+  const String ascii(37, 'a');
+  EXPECT_EQ(asciiPrefixSize(""), 0);
+  EXPECT_EQ(asciiPrefixSize(ascii), 37);
+  EXPECT_EQ(asciiPrefixSize(ascii + "犬" + ascii), 37);
+  EXPECT_EQ(asciiPrefixSize(ascii + ascii + "\x80"), 74);
+  const auto s{ascii + "犬" + ascii + "𠮟ã" + ascii + "\x80"};
+  EXPECT_EQ(countUtf8Starts(s), 3);
+  EXPECT_EQ(countUtf8Starts(s, false), 3 * ascii.size() + 3);
+  EXPECT_EQ(countUtf8Starts(StringView{s}.substr(0, 20)), 0);
+  EXPECT_EQ(findEitherPair(s, "xy", "\xe7\x8a"), 37);  // first bytes of 犬
+  EXPECT_EQ(findEitherPair(s, "xy", "\xf0\xa0"), 77);  // first bytes of 𠮟
+  EXPECT_EQ(findEitherPair(s, "a\x80", "xy"), s.size() - 2);
+  EXPECT_EQ(findEitherPair(s, "xy", "\xe7\x8b"), s.size()); // only 1st byte
+  EXPECT_EQ(findEitherPair(s, "xy", "\x80z"), s.size());     // last byte
+  EXPECT_EQ(findEitherPair("", "ab", "cd"), 0);
+  EXPECT_EQ(findEitherPair("a", "ab", "cd"), 1);
+  // check a pair that crosses a block boundary (at 8 or 16 bytes)
+  for (size_t i{1}; i < 20; ++i)
+    EXPECT_EQ(
+        findEitherPair(String(i, 'a') + "\xe3\x82", "xy", "\xe3\x82"), i);
+}
+
 TEST(Utf8Test, ConvertEmptyString) {
   EXPECT_EQ(fromUtf8(emptyString()), emptyCodeString());
   EXPECT_EQ(fromUtf8(""), emptyCodeString());
@@ -169,6 +270,81 @@ TEST(Utf8Test, fromUtf8WithMaxSize) {
   EXPECT_EQ(fromUtf8(utf8, 3), U"生命尊");
   for (const auto i : {0UL, 4UL, 5UL})
     EXPECT_EQ(fromUtf8(utf8, i), U"生命尊重");
+  // input is only read as far as needed for 'maxSize' values so it doesn't
+  // need to be null terminated
+  const std::array noNull{'a', 'b', 'c', 'd'};
+  EXPECT_EQ(fromUtf8(noNull.data(), 1), U"a");
+  const std::array truncated{'\xe7', '\x8a', '\xac', '\xe7', '\x8a'};
+  EXPECT_EQ(fromUtf8(truncated.data(), 1), U"犬");
+}
+
+TEST(Utf8Test, FromUtf8LongInput) {
+  // long input covers bulk conversion of Ascii blocks and three byte runs
+  const String ascii{"abcdefghijklmnopqrstuvwxyz0123456789"},
+      kana{"ひらがなカタカナ"};
+  String utf8;
+  CodeString expected;
+  for (auto i{0}; i < 5; ++i) {
+    utf8 += ascii + kana + "©𒀄";
+    expected += U"abcdefghijklmnopqrstuvwxyz0123456789ひらがなカタカナ©𒀄";
+  }
+  EXPECT_EQ(fromUtf8(utf8), expected);
+  EXPECT_EQ(fromUtf8ToWstring(utf8),
+      std::wstring(expected.begin(), expected.end()));
+  // max size can stop conversion in the middle of an Ascii or Kana run
+  EXPECT_EQ(fromUtf8(utf8, 20), expected.substr(0, 20));
+  EXPECT_EQ(fromUtf8(utf8, 40), expected.substr(0, 40));
+}
+
+TEST(Utf8Test, FromUtf8LongInputWithErrors) {
+  const String ascii(30, 'a');
+  // surrogate in the middle of a run of three byte values
+  EXPECT_EQ(fromUtf8(ascii + "犬犬" + SurrogateRangeStart + "犬" + ascii),
+      CodeString(30, U'a') + U"犬犬\ufffd犬" + CodeString(30, U'a'));
+  // truncated three byte value at the end of a run
+  EXPECT_EQ(fromUtf8(ascii + "犬" + Dog.substr(0, 2)),
+      CodeString(30, U'a') + U"犬\ufffd");
+  // continuation byte in the middle of Ascii
+  EXPECT_EQ(fromUtf8(ascii + '\x80' + ascii),
+      CodeString(30, U'a') + U"\ufffd" + CodeString(30, U'a'));
+}
+
+TEST(Utf8Test, Utf8View) {
+  static_assert(std::forward_iterator<Utf8View::Iterator>);
+  const String s{"a犬𠮟"};
+  CodeString codes;
+  std::vector<size_t> offsets, sizes;
+  for (auto i{Utf8View{s}.begin()}; i != Utf8View::Iterator{}; ++i) {
+    codes += *i;
+    offsets.push_back(i.offset());
+    sizes.push_back(i.size());
+  }
+  EXPECT_EQ(codes, U"a犬𠮟");
+  EXPECT_EQ(offsets, (std::vector<size_t>{0, 1, 4}));
+  EXPECT_EQ(sizes, (std::vector<size_t>{1, 3, 4}));
+  EXPECT_EQ(Utf8View{""}.begin(), Utf8View{""}.end());
+}
+
+TEST(Utf8Test, Utf8ViewWithErrors) {
+  // results should be the same as 'fromUtf8' for invalid values
+  for (auto& s : {String{"a\x80" "b"}, "犬" + Dog.substr(0, 2),
+           String{SurrogateRangeStart} + "x", String{"\xff"}}) {
+    CodeString codes;
+    for (const auto i : Utf8View{s}) codes += i;
+    EXPECT_EQ(codes, fromUtf8(s));
+  }
+}
+
+TEST(Utf8Test, Utf8ViewDoesntReadPastEnd) {
+  // view of the first part of a string (so not null-terminated) stops at the
+  // end of the view, i.e., truncated values are errors
+  const String s{"犬猫"};
+  CodeString codes;
+  for (const auto i : Utf8View{StringView{s}.substr(0, 4)}) codes += i;
+  EXPECT_EQ(codes, U"犬\ufffd");
+  codes.clear();
+  for (const auto i : Utf8View{StringView{s}.substr(0, 3)}) codes += i;
+  EXPECT_EQ(codes, U"犬");
 }
 
 TEST(Utf8Test, GetCode) {